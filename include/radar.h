@@ -0,0 +1,1011 @@
+// Radar sistemi ortak tanımları: donanım sabitleri, ekran profili, veri yapıları, modüller arası
+// global durum ve prototipler. Tanımlar modüllerdedir:
+//   main.cpp           setup/loop, Nextion girişi, seri konsol, istatistikler, çizim motoru, EEPROM
+//   nextion_out.cpp    öncelikli çıkış kuyruğu, akış kontrolü, hat senkronu, mesafe profili (addt)
+//   targets.cpp        hedef deposu ve toplu çekirdekler, poligon bölgeler, karmaşa, doluluk
+//   scene_backends.cpp şekil sahnesi çıkışları (Nextion çizim, piksel/TFT)
+#pragma once
+
+#include <Arduino.h>
+#include "driver/gpio.h"
+#include "driver/twai.h"
+#include <math.h>
+#include <HardwareSerial.h>
+#include <EEPROM.h>
+
+// SPI TFT sahne çıkışı (ILI9341/ST7789): -DDISPLAY_TFT=1 ile derlenir, "RENDER TFT" ile seçilir
+#ifndef DISPLAY_TFT
+  #define DISPLAY_TFT 0
+#endif
+#if DISPLAY_TFT == 1
+  #include "driver/spi_master.h"
+  #include "esp_heap_caps.h"
+#endif
+
+// -------------------------------------------------------------------------------------------------
+// DEBUG AYARLARI
+// -------------------------------------------------------------------------------------------------
+#define DEBUG_CAN      0
+#define DEBUG_NEXTION  1  // Komutları görmek için açık
+#define DEBUG_RADAR    0
+#define DEBUG_BUZZER   0
+#define DEBUG_EEPROM   1
+#ifndef SELFTEST_FIXEDPOINT
+  #define SELFTEST_FIXEDPOINT 0  // Açılışta tamsayı hattını eski float hesabına karşı doğrular (-DSELFTEST_FIXEDPOINT=1)
+#endif
+#define DEBUG_TIMING   0  // Lojik analizör: TIMING_FRAME_PIN kare hazırlanırken, TIMING_TX_PIN TX kuyruğu doluyken HIGH
+
+#if DEBUG_NEXTION == 1
+  #define NEXTION_PRINTF(...) Serial.printf(__VA_ARGS__)
+#else
+  #define NEXTION_PRINTF(...)
+#endif
+#if DEBUG_RADAR == 1
+  #define RADAR_PRINTF(...) Serial.printf(__VA_ARGS__)
+  #define RADAR_PRINTLN(x) Serial.println(x)
+#else
+  #define RADAR_PRINTF(...)
+  #define RADAR_PRINTLN(x)
+#endif
+#if DEBUG_BUZZER == 1
+  #define BUZZER_PRINTLN(x) Serial.println(x)
+#else
+  #define BUZZER_PRINTLN(x)
+#endif
+#if DEBUG_EEPROM == 1
+  #define EEPROM_PRINTLN(x) Serial.println(x)
+#else
+  #define EEPROM_PRINTLN(x)
+#endif
+#if DEBUG_CAN == 1
+  #define CAN_PRINTF(...) Serial.printf(__VA_ARGS__)
+#else
+  #define CAN_PRINTF(...)
+#endif
+#if DEBUG_TIMING == 1
+  #define TIMING_SET(pin, level) digitalWrite(pin, level)
+#else
+  #define TIMING_SET(pin, level)
+#endif
+
+// -------------------------------------------------------------------------------------------------
+// DONANIM VE SABİTLER
+// -------------------------------------------------------------------------------------------------
+#define CAN_TX_PIN GPIO_NUM_5
+#define CAN_RX_PIN GPIO_NUM_4
+#define BUZZER_PIN 25
+#define TIMING_FRAME_PIN 26 // Sadece DEBUG_TIMING
+#define TIMING_TX_PIN    27
+#define TFT_PIN_MOSI     23 // Sadece DISPLAY_TFT (VSPI)
+#define TFT_PIN_SCLK     18
+#define TFT_PIN_CS       14
+#define TFT_PIN_DC       21
+#define TFT_PIN_RST      22
+
+const long SERIAL_MONITOR_BAUD = 115200;
+const long NEXTION_BAUD        = 9600;
+const int  RX_BUFFER_SIZE      = 64;
+const int  CONSOLE_BUFFER_SIZE = 64;
+const int  NEXTION_TX_BUFFER_SIZE = 1024; // Yazma bloklanmasın, birikme ölçülebilsin
+const int  UART_HW_FIFO_LEN       = 128;
+const int  NEXTION_RX_IDLE_MS     = 50;   // Sonlandırıcısız mesaj bu sessizlikten sonra işlenir
+
+// Öncelikli Çıkış Kuyruğu: komutlar önce RAM'de bekler, UART tamponunda en fazla ~60 ms'lik hat
+// (loop CAN'de en çok 50 ms bekler) tutulur; alarm komutu bu sınırın arkasında sadece o kadar bekler.
+const int  NEX_QUEUE_LEN          = 32;
+const int  NEX_CMD_MAX            = 48;   // Sığmayan komut kuyruk boşaltılıp doğrudan yazılır
+const int  NEX_TX_HIGH_WATER      = NEXTION_BAUD / 10 * 60 / 1000;
+const uint8_t NEX_PRIO_ALARM      = 0;    // page 0, alarm karesi (kırmızı arka plan ya da alarm rengine geçen marker)
+const uint8_t NEX_PRIO_NORMAL     = 1;    // Kare (ref_stop..ref_star: sahne, marker, alanlar, durum), sendme
+const uint8_t NEX_PRIO_LOW        = 2;    // Kare dışı arka plan: ayar senkronu
+
+// Nextion dönüş kodları ve sayfalar
+const uint8_t NEX_RET_TOUCH_EVENT  = 0x65;
+const uint8_t NEX_RET_CURRENT_PAGE = 0x66;
+const uint8_t NEX_PAGE_MAIN        = 0;     // page0: radar ekranı, pageSet1..3: ayarlar
+const int     NEXTION_PAGE_POLL_MS = 1000;  // sendme yoklaması (HMI sayfa olayı göndermese de)
+const uint8_t NEX_RET_SUCCESS      = 0x01;
+const uint8_t NEX_RET_LAST_CODE    = 0x24;  // 0x00-0x24: komut dönüş/hata kodları
+const uint8_t NEX_RET_STARTUP      = 0x00;  // 00 00 00: ekran açıldı (güç/reset)
+const uint8_t NEX_RET_READY        = 0x88;  // Ekran komut almaya hazır
+const uint8_t NEX_RET_ADDT_READY   = 0xFE;  // addt: şeffaf veri bekleniyor
+const uint8_t NEX_RET_ADDT_DONE    = 0xFD;  // addt: şeffaf veri tamamlandı
+
+// Hat Sağlığı: sendme yoklaması 1 s'de bir cevap üretir; 3 yoklama boyunca hiç bayt gelmezse hat koptu sayılır.
+// Ekran açılış/hazır olayı ya da kopukluktan sonraki ilk mesaj tam senkron başlatır.
+const int     NEXTION_LINK_TIMEOUT_MS = 3 * NEXTION_PAGE_POLL_MS + 500;
+const int     SETTINGS_ITEM_COUNT  = 7;     // sendSettingToNextion() komut sayısı
+
+// Akış Kontrolü (FLOW ON): bkcmd=3 ile her komut 0x01 ya da hata kodu döndürür, sendme 0x66.
+// Cevapsız komut sayısı kredidir; kredi bitince kritik olmayan çıktı (kare, yoklama) bekler.
+const int     NEX_CREDIT_LIMIT     = 16;    // ~16 komut x ~20 bayt, Nextion'ın ~1 KB tamponunun çok altında
+const int     NEX_ACK_RING         = 64;    // Gönderim zamanları (alarm komutları sınırı aşabilir)
+const int     NEX_ACK_TIMEOUT_MS   = 500;   // Cevap gelmezse kredi geri alınır (sızıntı olmasın)
+
+struct NexErrorName { uint8_t code; const char* name; };
+const NexErrorName NEX_ERRORS[] = {
+  { 0x00, "gecersiz komut" },     { 0x02, "gecersiz bilesen" },  { 0x03, "gecersiz sayfa" },
+  { 0x04, "gecersiz resim" },     { 0x05, "gecersiz font" },     { 0x1A, "gecersiz degisken" },
+  { 0x1B, "gecersiz islem" },     { 0x1C, "atama hatasi" },      { 0x1E, "parametre sayisi" },
+  { 0x1F, "IO hatasi" },          { 0x23, "degisken adi uzun" }, { 0x24, "seri tampon tasti" },
+};
+const int NEX_ERROR_KINDS = sizeof(NEX_ERRORS) / sizeof(NEX_ERRORS[0]);
+
+// --- Radar CAN ID Aralığı ---
+// 0x310 - 0x38F: 8 sensör x 16 nesne. Slot = identifier - RADAR_ID_FIRST.
+const uint32_t RADAR_ID_FIRST           = 0x310;
+const uint32_t RADAR_ID_LAST            = 0x38F;
+const int      RADAR_SLOT_COUNT         = RADAR_ID_LAST - RADAR_ID_FIRST + 1; // 128
+const int      RADAR_OBJECTS_PER_SENSOR = 16;
+const int      RADAR_SENSOR_COUNT       = RADAR_SLOT_COUNT / RADAR_OBJECTS_PER_SENSOR; // 8
+const int      CAN_RX_QUEUE_LEN         = 32;  // Sürücü varsayılanı (5) çok sensörde taşar
+const int      CAN_DRAIN_MAX            = RADAR_SLOT_COUNT; // Döngü başına en fazla çerçeve
+const int      TARGET_HOLD_MS           = 100; // Yenilenmeyen hedef bu süreden sonra düşer
+
+// --- EEPROM ---
+#define EEPROM_SIZE 1024
+const int EEPROM_MAGIC_KEY    = 124;
+const int ADDR_MAGIC_KEY      = 0;
+const int ADDR_WARN_ZONE      = 4;
+const int ADDR_DANGER_ZONE    = 8;
+const int ADDR_VEHICLE_WIDTH  = 12;
+// ADDR_PASSWORD artik ESP32 tarafindan aktif kullanilmiyor ama yerini koruyoruz
+const int ADDR_PASSWORD       = 16; 
+const int ADDR_AUTOZOOM_EN    = 44;
+const int ADDR_AUDIOALARM_EN  = 45;
+const int ADDR_SIDE_MARGIN    = 48;
+const int ADDR_MAX_WIDTH      = 52;
+const int ADDR_SENSOR_TIMEOUT = 56; // uint16_t, 0 = ayarlanmamis (varsayilan kullanilir)
+const int ADDR_SENSOR_MASK    = 58; // uint8_t,  0 = ayarlanmamis (varsayilan kullanilir)
+const int ADDR_STEER_CAN_ID   = 60; // uint16_t, 0 = direksiyon girişi kapalı
+const int ADDR_WHEELBASE      = 62; // uint16_t (cm), 0 = ayarlanmamis
+const int ADDR_SPEED_CAN_ID   = 64; // uint16_t, 0 = hız girişi kapalı
+const int ADDR_SPEED_OPTIONS  = 66; // uint8_t, bit0 = yaw rate kullan
+const int ADDR_CLUTTER_OPTIONS = 67; // uint8_t, bit0 = karmaşa maskesi uygula
+const int ADDR_OCC_OPTIONS    = 68; // uint8_t, bit0 = yakın engel katmanı, bit1 = doluluk onayı
+const int ADDR_MARKER_POOL    = 69; // uint8_t, 0 = ayarlanmamis
+const int ADDR_DISPLAY_OPTIONS = 70; // uint8_t, bit0 = paketli protokol, bit1 = sayısal alanlar, bit2 = akış kontrolü,
+                                     //          bit3 = move animasyonu, bit4 = anlık çizim, bit5 = mesafe profili,
+                                     //          bit6 = SPI TFT sahne
+const int ADDR_REFRESH_CLASSES = 72; // uint8_t[ELEMENT_COUNT], 6 bayt, sınıf + 1 (0 = varsayılan)
+const int ADDR_ELEMENT_BUDGET = 78; // uint16_t, bayt/s
+const int ADDR_POLY_ZONES     = 128; // PolyZone[POLY_ZONE_MAX], 136 bayt
+const int ADDR_CLUTTER_MASK   = 264; // uint8_t[GRID_CELLS / 8], 512 bayt
+
+// Varsayılanlar
+const float DEFAULT_WARNING_ZONE_M    = 5.0;
+const float DEFAULT_DANGER_ZONE_M     = 2.0;
+const float DEFAULT_VEHICLE_WIDTH_M   = 2.0; 
+const float DEFAULT_SIDE_MARGIN_M     = 0.5;
+const float DEFAULT_MAX_WIDTH_M       = 10.0;
+const bool  DEFAULT_AUTOZOOM_EN       = true;
+const bool  DEFAULT_AUDIOALARM_EN     = true;
+const uint16_t DEFAULT_SENSOR_TIMEOUT_MS = 500;
+const uint8_t  DEFAULT_SENSOR_MASK       = 0x01; // Beklenen sensörler (bit n = sensör n)
+const uint16_t DEFAULT_STEER_CAN_ID      = 0;    // Kapalı
+const uint16_t DEFAULT_WHEELBASE_CM      = 250;
+const uint16_t DEFAULT_SPEED_CAN_ID      = 0;    // Kapalı
+const uint8_t  DEFAULT_SPEED_OPTIONS     = 0;
+const uint8_t  DEFAULT_CLUTTER_OPTIONS   = 0;
+const uint8_t  DEFAULT_OCC_OPTIONS       = 0;
+const uint8_t  DEFAULT_MARKER_POOL       = 1;    // Eski HMI'da sadece rTarget var; MARKERS 4 ile açılır
+const uint8_t  DEFAULT_DISPLAY_OPTIONS   = 0;
+const uint16_t DEFAULT_ELEMENT_BUDGET_BPS = NEXTION_BAUD / 10 / 4; // Hattın dörtte biri
+
+// Sensör Denetimi
+const uint16_t SENSOR_TIMEOUT_MIN_MS          = 100;
+const uint16_t SENSOR_TIMEOUT_MAX_MS          = 10000;
+const int      SENSOR_SUPERVISION_PERIOD_MS   = 100;
+
+// Direksiyon Açısı (Kavisli Koridor)
+// Çerçeve: data[0..1] işaretli 16 bit little-endian, 0.1 derece/bit, pozitif = sola.
+// Model: sensör arka aks hizasında; dönme merkezi sensörün yanal ekseninde (0, R).
+const int      STEER_ANGLE_BYTE        = 0;
+const int      STEER_SIGN              = 1;     // Sensör montajına göre yön çevirmek için -1
+const int      STEER_DEADBAND_DDEG     = 5;     // |açı| < 0.5 derece -> düz koridor
+const int32_t  STEER_MAX_RADIUS_CM     = 10000; // Daha büyük yarıçap düz sayılır
+const int      STEER_TIMEOUT_MS        = 500;   // Direksiyon verisi bayatlarsa düz koridor
+const uint16_t WHEELBASE_MIN_CM        = 50;
+const uint16_t WHEELBASE_MAX_CM        = 2000;
+
+// Araç Hızı ve Yaw (Ego-Hareket)
+// Çerçeve: data[0..1] hız, işaretli 16 bit LE, 0.01 km/h/bit, pozitif = sensörün baktığı yöne.
+//          data[2..3] yaw rate, işaretli 16 bit LE, 0.01 derece/s/bit, pozitif = sola.
+const int      SPEED_BYTE              = 0;
+const int      YAW_BYTE                = 2;
+const uint8_t  SPEED_OPT_YAW           = 0x01;
+const int      SPEED_TIMEOUT_MS        = 500;   // Bayat hız verisiyle bastırma/ölçekleme yapılmaz
+const int      EGO_STOPPED_CMS         = 10;    // Bu hızın altında araç durmuş sayılır
+const int      STATIC_TARGET_CMS       = 30;    // Zemine göre bu hızın altı sabit nesne (L1)
+const int      ZONE_SPEED_LOOKAHEAD_MS = 1000;  // Bölge eşikleri hız x bu süre kadar genişler
+const int      ZONE_SPEED_MARGIN_MAX_CM = 500;
+const int      YAW_DEADBAND_MRADS      = 10;    // Yaw'dan yarıçap için alt sınırlar
+const int      YAW_MIN_SPEED_CMS       = 20;
+
+// Araç Izgarası: araç çerçevesinde, radar çözünürlüğünde (25 cm) hücreler.
+// Hücre (cx, cy) tam olarak radarın bir kafes noktasıdır: cx = data[2], cy = data[3] - 128 + 32.
+const int      GRID_CELL_CM            = 25;
+const int      GRID_X_CELLS            = 64;  // İleri   0 .. 15.75 m
+const int      GRID_Y_CELLS            = 64;  // Yanal  -8 .. 7.75 m
+const int      GRID_CELLS              = GRID_X_CELLS * GRID_Y_CELLS;
+
+// Poligon Alarm Bölgeleri (araç çerçevesi, cm)
+const int      POLY_ZONE_MAX           = 4;
+const int      POLY_VERTEX_MAX         = 8;
+
+// Sabit Karmaşa Öğrenme (kova, ayna, merdiven gibi araca bağlı parçalar)
+// Öğrenme süresince her örnekte aktif hedeflerin hücreleri sayılır; örneklerin en az
+// CLUTTER_LEARN_PERCENT kadarında dolu olan hücreler (ve komşuları) maskelenir.
+const uint8_t  CLUTTER_OPT_ENABLE      = 0x01;
+const int      CLUTTER_SAMPLE_MS       = 200;   // 50 s x 5 Hz = 250 örnek, uint8_t sayaca sığar
+const int      CLUTTER_LEARN_MIN_S     = 5;
+const int      CLUTTER_LEARN_MAX_S     = 50;
+const int      CLUTTER_LEARN_DEFAULT_S = 20;
+const int      CLUTTER_LEARN_PERCENT   = 50;
+const int      CLUTTER_DILATE_CELLS    = 1;     // Radar toleransı (±0.25 m)
+
+// Doluluk Izgarası: hücre başına 0-255, her taramada isabet eklenir, sabit periyotla v = v * 7/8.
+// 255'ten OCC_OVERLAY_MIN'e ~16 periyot (~4 s) "yakın geçmiş" hafızası verir.
+const uint8_t  OCC_OPT_OVERLAY         = 0x01;
+const uint8_t  OCC_OPT_CONFIRM         = 0x02;
+const int      OCC_HIT                 = 64;    // Tarama başına isabet
+const int      OCC_DECAY_MS            = 250;
+const int      OCC_CONFIRM             = 96;    // Onay açıkken alarm için gereken doluluk (>= 2 isabet)
+const int      OCC_OVERLAY_MIN         = 32;
+const int      OCC_OVERLAY_MAX_CELLS   = 4;     // 9600 baud: kare başına ~25 bayt/hücre
+const int      OCC_OVERLAY_COLOR       = 33808; // Gri
+
+// Ekran Profilleri (derleme zamanında seçilir: -DSCREEN_PROFILE=SCREEN_PROFILE_...)
+// Ölçek her profilde ekran genişliğine göre: yatay profillerde ileri görüş mesafesi kısalır.
+#define SCREEN_PROFILE_272x480  0  // 4.3" dikey (varsayılan)
+#define SCREEN_PROFILE_320x480  1  // 3.5" dikey
+#define SCREEN_PROFILE_480x800  2  // 5" / 7" dikey
+#define SCREEN_PROFILE_480x272  3  // 4.3" yatay
+#define SCREEN_PROFILE_480x320  4  // 3.5" yatay
+#define SCREEN_PROFILE_800x480  5  // 5" / 7" yatay
+#define SCREEN_PROFILE_240x320  6  // 2.4" / 2.8" dikey (Nextion NX3224 ya da SPI TFT)
+#ifndef SCREEN_PROFILE
+  #define SCREEN_PROFILE SCREEN_PROFILE_272x480
+#endif
+
+template <int W, int H, int TARGET, int VEHICLE_H, int PIC_SAFE, int PIC_WARNING, int PIC_DANGER, int PIC_ALARM>
+struct ScreenProfile {
+  static constexpr int width         = W;
+  static constexpr int height        = H;
+  static constexpr int targetSize    = TARGET;
+  static constexpr int vehicleHeight = VEHICLE_H;
+  static constexpr int picSafe       = PIC_SAFE;     // 10m
+  static constexpr int picWarning    = PIC_WARNING;  // 8m
+  static constexpr int picDanger     = PIC_DANGER;   // 6m
+  static constexpr int picAlarm      = PIC_ALARM;    // 4m
+};
+
+#if   SCREEN_PROFILE == SCREEN_PROFILE_272x480
+  typedef ScreenProfile<272, 480, 30, 10, 4, 1, 2, 0> Screen;
+#elif SCREEN_PROFILE == SCREEN_PROFILE_320x480
+  typedef ScreenProfile<320, 480, 34, 12, 4, 1, 2, 0> Screen;
+#elif SCREEN_PROFILE == SCREEN_PROFILE_480x800
+  typedef ScreenProfile<480, 800, 52, 18, 4, 1, 2, 0> Screen;
+#elif SCREEN_PROFILE == SCREEN_PROFILE_480x272
+  typedef ScreenProfile<480, 272, 30, 10, 4, 1, 2, 0> Screen;
+#elif SCREEN_PROFILE == SCREEN_PROFILE_480x320
+  typedef ScreenProfile<480, 320, 34, 12, 4, 1, 2, 0> Screen;
+#elif SCREEN_PROFILE == SCREEN_PROFILE_800x480
+  typedef ScreenProfile<800, 480, 52, 18, 4, 1, 2, 0> Screen;
+#elif SCREEN_PROFILE == SCREEN_PROFILE_240x320
+  typedef ScreenProfile<240, 320, 26, 9, 4, 1, 2, 0> Screen;
+#else
+  #error "Bilinmeyen SCREEN_PROFILE"
+#endif
+
+static_assert(Screen::targetSize < Screen::width && Screen::targetSize < Screen::height, "Hedef ekrandan buyuk");
+static_assert(Screen::vehicleHeight < Screen::height, "Arac yuksekligi ekrandan buyuk");
+static_assert(Screen::width <= (1 << 10) && Screen::height <= (1 << 10), "Paketli protokol 10 bit koordinat tasir");
+static_assert(Screen::picSafe < 256 && Screen::picWarning < 256 && Screen::picDanger < 256 && Screen::picAlarm < 256,
+              "Paketli protokol 8 bit resim ID tasir");
+
+// Ekran Özellikleri (profilden; tüm piksel hesapları sabit olarak katlanır)
+constexpr int SCREEN_WIDTH_PX       = Screen::width;
+constexpr int SCREEN_HEIGHT_PX      = Screen::height;
+constexpr int TARGET_OBJECT_SIZE_PX = Screen::targetSize;
+constexpr int VEHICLE_HEIGHT_PX     = Screen::vehicleHeight;
+const int     VEHICLE_COLOR         = 31;
+
+// Nextion Resim ID'leri
+constexpr int PIC_ID_SAFE    = Screen::picSafe;     // 10m
+constexpr int PIC_ID_WARNING = Screen::picWarning;  // 8m
+constexpr int PIC_ID_DANGER  = Screen::picDanger;   // 6m
+constexpr int PIC_ID_ALARM   = Screen::picAlarm;    // 4m
+
+// Renkler
+const int COLOR_RED      = 63488;
+const int COLOR_ORANGE   = 64512;
+const int COLOR_YELLOW   = 65504;
+const int COLOR_GREEN    = 2016;
+
+// Bölge Seviyeleri ve seviye başına görsel tablolar (indeks = ZoneLevel)
+// Tüm mesafeler santimetre (tamsayı). Radar 0.25 m = 25 cm, ayarlar 0.1 m = 10 cm çözünürlüklü.
+enum ZoneLevel : uint8_t { ZONE_SAFE = 0, ZONE_WARNING = 1, ZONE_DANGER = 2, ZONE_ALARM = 3 };
+const int16_t ZONE_GRID_CM[4] = { 1000, 800, 600, 400 };  // AutoZoom kademeleri
+const int16_t DEFAULT_GRID_CM = 1000;
+const int16_t AUTOZOOM_SAFE_CM    = 500;
+const int16_t AUTOZOOM_WARNING_CM = 300;
+const int16_t AUTOZOOM_DANGER_CM  = 150;
+const int   ZONE_PIC_ID[4]  = { PIC_ID_SAFE, PIC_ID_WARNING, PIC_ID_DANGER, PIC_ID_ALARM };
+const int   ZONE_COLOR[4]   = { COLOR_GREEN, COLOR_YELLOW, COLOR_ORANGE, COLOR_RED };
+
+// Tahminli Çizim: marker, ekrana ulaşacağı ana ileri kestirilir
+const int   PREDICTION_MAX_MS       = 300;
+
+// Buzzer
+const int   SOLID_TONE_DISTANCE_CM  = 75;
+const int   BEEP_ON_DURATION_MS     = 60;
+const int   BEEP_INTERVAL_YELLOW_MS = 400;
+const int   BEEP_INTERVAL_ORANGE_MS = 200;
+const int   BEEP_INTERVAL_RED_MS    = 80;
+// Marker Havuzu: HMI'da önceden yerleştirilmiş hedef nesneleri. İlk marker eski HMI ile
+// uyum için "rTarget" adını korur, ek marker'lar rTarget1..N (aynı boyut, başlangıçta gizli).
+const int         MARKER_POOL_SIZE     = 4;
+const char* const MARKER_NAME[MARKER_POOL_SIZE] = { "rTarget", "rTarget1", "rTarget2", "rTarget3" };
+const int         MARKER_UPDATE_BYTES  = 60;   // Ek marker için en kötü durum: vis + pco + x + y
+
+// Paketli Protokol (PROTO PACKED): hedef ve sahne başına tek sayı değişkeni, HMI zamanlayıcısı açar.
+// Marker (vT0..vT3): bit 0-9 x, 10-19 y, 20-21 bölge (renk HMI'da), 22 görünür.
+// Sahne (vScene):    bit 0-7 arka plan resmi, 8-17 araç x, 18-27 araç genişliği.
+const uint8_t     DISPLAY_OPT_PACKED   = 0x01;
+const char* const MARKER_VAR[MARKER_POOL_SIZE] = { "vT0", "vT1", "vT2", "vT3" };
+const int         PACK_COORD_BITS      = 10;
+const int         PACK_Y_SHIFT         = 10;
+const int         PACK_ZONE_SHIFT      = 20;
+const int         PACK_VIS_SHIFT       = 22;
+const int         SCENE_VEH_X_SHIFT    = 8;
+const int         SCENE_VEH_W_SHIFT    = 18;
+
+// Sayısal Alanlar (FIELDS NUMERIC): metin alanları yerine Xfloat (vvs1 = 2, cm -> "m.cc") ve Number.
+// Değer santimetre tamsayı olarak gider, biçimlendirme ekranda; sadece değişen alan gönderilir.
+const uint8_t     DISPLAY_OPT_NUMERIC  = 0x02;
+const int         FIELD_COUNT          = 4;
+const char* const FIELD_TEXT[FIELD_COUNT]    = { "tMesafe", "tAci", "tX", "tY" };
+const char* const FIELD_NUMERIC[FIELD_COUNT] = { "xMesafe", "nAci", "xX", "xY" };
+
+// Yenileme Sınıfları: hedef alanları, durum ve araç geometrisi kendi sınıfına göre ve saniye başına bayt
+// bütçesinden (kova, en fazla 1 s birikir) gönderilir. Alanlar 0-3 FIELD_TEXT/FIELD_NUMERIC sırasıyla aynı.
+enum RefreshClass : uint8_t { REFRESH_FRAME = 0, REFRESH_4HZ = 1, REFRESH_1HZ = 2, REFRESH_CHANGE = 3 };
+const int         EL_STATUS            = FIELD_COUNT;
+const int         EL_VEHICLE           = FIELD_COUNT + 1;
+const int         ELEMENT_COUNT        = FIELD_COUNT + 2;
+const char* const ELEMENT_NAME[ELEMENT_COUNT] = { "MESAFE", "ACI", "X", "Y", "DURUM", "ARAC" };
+const char* const REFRESH_NAME[4]      = { "FRAME", "4HZ", "1HZ", "CHANGE" };
+const uint16_t    REFRESH_PERIOD_MS[4] = { 0, 250, 1000, 0 };
+const uint8_t     DEFAULT_REFRESH_CLASS[ELEMENT_COUNT] = {
+  REFRESH_4HZ, REFRESH_1HZ, REFRESH_1HZ, REFRESH_1HZ, REFRESH_CHANGE, REFRESH_CHANGE
+};
+const uint16_t    ELEMENT_BUDGET_MIN_BPS = 20;
+const uint16_t    ELEMENT_BUDGET_MAX_BPS = NEXTION_BAUD / 10;
+const int32_t     ELEMENT_UNKNOWN      = INT32_MIN;
+// EL_STATUS değerleri: tDurum metni STATUS_TEXT sırasıyla
+enum StatusCode : uint8_t { STATUS_CLEAR = 0, STATUS_TARGET = 1, STATUS_FAULT = 2 };
+const char* const STATUS_TEXT[3]       = { "Temiz", "HEDEF", "SENSOR HATA" };  // Ekrandaki değer bilinmiyor: sınıf beklemeden gönder
+
+// Akış Kontrolü (FLOW ON): kredi sınırları Nextion dönüş kodlarının yanında (NEX_CREDIT_LIMIT).
+const uint8_t     DISPLAY_OPT_FLOW     = 0x04;
+
+// Animasyon (ANIM ON): marker x/y yerine "move rTargetK,x0,y0,x1,y1,0,süre". Ekran tarama boyunca ara
+// konumları kendisi çizer; hedef konum bir çizim aralığı sonrası için kestirilir. Sadece metin protokolü.
+const uint8_t     DISPLAY_OPT_MOVE     = 0x08;
+const int         MOVE_MIN_MS          = 40;
+const int         MOVE_MAX_MS          = 500;
+const int         MOVE_SMOOTH_FRAME_MS = 50;    // Karşılaştırma: x/y ile aynı akıcılık için 20 Hz
+
+// Anlık Çizim (RENDER DRAW): marker, araç, bölge yayları (cir), koridor (line) ve bölge şeridi fill/line/cir
+// ile çizilir; rTarget/rVehicle gizlenir. Kare sonunda önceki çizimle fark alınır: kaybolan/değişen şekillerin
+// kutusu arka plan rengiyle silinir (kirli dikdörtgen), sadece yeni şekiller ve silinen alana değenler çizilir.
+const uint8_t     DISPLAY_OPT_DRAW     = 0x10;
+const int         DRAW_PRIM_MAX        = 12;    // 4 marker + araç + 2 yay + 2 koridor + şerit
+const int         DRAW_BG_COLOR        = 0;     // Siyah
+const int         DRAW_CORRIDOR_COLOR  = 33808; // Gri
+const int         DRAW_ZONE_BAR_PX     = 6;     // Üstte bölge rengi şerit (arka plan resmi yerine)
+enum DrawKind : uint8_t { DRAW_FILL = 0, DRAW_CIRCLE = 1, DRAW_LINE = 2 };
+
+// Piksel çıkışı (RENDER TFT): aynı şekil listesi ve kare farkı, çıkış Nextion komutu yerine kirli bölgelerin
+// şeritler halinde rasterize edilip bir piksel hedefine (PixelSink) verilmesi: cihazda SPI TFT + DMA,
+// masaüstü testinde çerçeve tamponu. Çözünürlük ekran profiliyle aynıdır. Metin alanları, ayar sayfaları
+// ve mesafe profili Nextion'da kalır. Piksel hedefi yoksa (DISPLAY_TFT=0) bit açılmaz.
+const uint8_t     DISPLAY_OPT_TFT      = 0x40;
+const uint8_t     DISPLAY_OPT_PRIMS    = DISPLAY_OPT_DRAW | DISPLAY_OPT_TFT;  // Sahne şekillerle çizilir
+enum SceneRenderer : uint8_t { RENDERER_COMPONENTS = 0, RENDERER_DRAW = 1, RENDERER_TFT = 2, RENDERER_COUNT };
+#define TFT_CONTROLLER_ILI9341 0
+#define TFT_CONTROLLER_ST7789  1
+#ifndef TFT_CONTROLLER
+  #define TFT_CONTROLLER TFT_CONTROLLER_ILI9341
+#endif
+const int         TFT_SPI_HZ           = 40000000;
+const int         RASTER_BAND_LINES    = 16;     // Şerit yüksekliği: TFT'de iki şerit tamponu DMA'da sırayla
+const int         RASTER_BAND_PIXELS   = SCREEN_WIDTH_PX * RASTER_BAND_LINES;
+const int         RASTER_REGION_MAX    = 2 * DRAW_PRIM_MAX + 1;
+
+// Mesafe Profili (PROFILE ON): tarama başına en yakın hedef mesafesi halka tampona yazılır, saniyede bir
+// "addt sProfile.id,0,n" + n ham bayt ile waveform'a tek seferde aktarılır (nokta başına "add" yerine).
+// Aktarım sürerken kuyruk bekletilir (ekran sonraki n baytı veri sayar); kuyruk dolarsa yeni komut düşer
+// (alarm, en yeni alarm olmayan komutun yerini alır), hatta yazılmaz. Alarm varken aktarım ertelenir.
+const uint8_t     DISPLAY_OPT_PROFILE  = 0x20;
+const int         PROFILE_POINTS       = 200;   // Waveform genişliği (piksel = nokta)
+const int         PROFILE_HEIGHT_PX    = 60;    // Waveform yüksekliği; yakın hedef = yüksek çubuk
+const int         PROFILE_RANGE_CM     = DEFAULT_GRID_CM;
+const int         PROFILE_PERIOD_MS    = 1000;
+const int         PROFILE_TIMEOUT_MS   = 300;   // addt'den hazır/bitti cevabına kadar
+
+// Kare başına bayt bütçesi: hedef kare süresinde hattın taşıyabildiği (8N1: bayt başına 10 bit)
+const int         RENDER_FRAME_MS      = 250;
+const int         FRAME_BYTE_BUDGET    = NEXTION_BAUD / 10 * RENDER_FRAME_MS / 1000;
+
+// Uyarlamalı Çizim Hızı (RATE AUTO): 500 ms'de bir ortalama kare baytı ve TX kuyruğundan çizim aralığı
+// (hattın %80'i hedeflenir) ve ayrıntı düzeyi seçilir. Ayrıntı değişiminden sonra 2 s beklenir.
+enum RenderLod : uint8_t { LOD_POSITION = 0, LOD_COLOR = 1, LOD_TEXT = 2 };
+const int         RATE_CTRL_MS         = 500;
+const int         RATE_TARGET_BPS      = NEXTION_BAUD / 10 * 80 / 100;
+const int         RENDER_MIN_MS        = 50;
+const int         RENDER_MAX_MS        = 500;
+const int         RENDER_LOD_DOWN_MS   = 350;   // İstenen aralık bunu aşarsa ayrıntı düşer
+const int         RENDER_LOD_UP_MS     = 200;   // Bir üst düzeyle bunun altında kalınırsa ayrıntı artar
+const int         RATE_LOD_HOLD_MS     = 2000;
+const int         LOD_COLOR_BYTES_EST  = 16;    // page0.pic her kare (pco sadece bölge değişiminde)
+const int         LOD_TEXT_BYTES_EST   = 90;    // Alan ölçümü yokken metin alanları tahmini
+
+const int   FAULT_BEEP_ON_MS        = 300;  // Sensör hatası: uzun ve seyrek bip
+const int   FAULT_BEEP_INTERVAL_MS  = 1500;
+
+// -------------------------------------------------------------------------------------------------
+// VERİ YAPILARI VE GLOBAL DURUM
+// -------------------------------------------------------------------------------------------------
+extern HardwareSerial SerialNextion;
+extern bool targetVisible;
+extern int  renderedTarget;  // Ekranda gösterilen depo slotu
+extern char rxBuffer[RX_BUFFER_SIZE];
+extern int  rxLength;
+extern unsigned long rxLast_ms;
+
+// Nextion Sayfa Takibi: sendme (0x66) cevapları ve dokunma olaylarından (0x65) güncellenir.
+// Ana sayfa dışındayken çizim yapılmaz; ana sayfaya dönüşte tek seferlik tam senkron.
+extern uint8_t       nextionPage;
+extern bool          pageResyncPending;
+extern unsigned long pagePollNext_ms;
+extern int           alarmTarget;  // Buzzer'ın seçtiği hedef (ses kapalı olsa da)
+struct PageStats {
+  uint32_t changes;
+  uint32_t suppressed;     // Ana sayfa dışındayken çizilmeyen kareler
+  uint32_t alarmReturns;   // Alarm nedeniyle ana sayfaya zorla dönüş
+};
+extern PageStats pageStats;
+
+// Akış kontrolü: cevap bekleyen komutların gönderim zamanları (FIFO, Nextion sırayla cevaplar)
+extern uint32_t nexAckSent_ms[NEX_ACK_RING];
+extern uint16_t nexAckBatch[NEX_ACK_RING];  // Kayıttaki komut sayısı (halka dolunca > 1)
+extern uint8_t  nexAckHead;
+extern uint8_t  nexAckSlots;
+extern uint16_t nexAckCount;                // Cevap bekleyen toplam komut (kullanılan kredi)
+struct FlowStats {
+  uint32_t acks;
+  uint32_t rttSum_ms;
+  uint32_t rttMax_ms;
+  uint32_t timeouts;       // Cevapsız kalıp zaman aşımına uğrayan komutlar
+  uint32_t paused;         // Kredi yokken atlanan kareler
+  uint32_t held;           // Kredi yokken kuyrukta bekletilen boşaltma
+  uint32_t merged;         // Halka dolu: en yeni kayda eklenen komut (kredisi yine tutulur)
+  uint32_t dropped;        // Kuyruk doluyken kredi olmadığı için düşen komut
+  uint32_t outstandingMax;
+  uint32_t errors[NEX_ERROR_KINDS + 1]; // Son eleman: tabloda olmayan kodlar
+};
+extern FlowStats flowStats;
+
+// Hat Sağlığı: son gelen bayt rxLast_ms; tam senkronda ayarlar sahneden sonra, TX boşken tek tek gider.
+extern bool nextionLinkUp;
+extern int  settingsResyncNext;  // Sıradaki ayar komutu (COUNT = bekleyen yok)
+extern unsigned long linkResyncStart_ms;
+struct LinkStats {
+  uint32_t startups;
+  uint32_t readies;
+  uint32_t timeouts;
+  uint32_t resyncs;
+  uint32_t ignored;        // Senkron sürerken gelen tetikler
+  uint32_t resyncMax_ms;   // Tetikten son ayar komutuna kadar
+};
+extern LinkStats linkStats;
+
+// Ayar Değişkenleri
+extern float warningZone_m, dangerZone_m, vehicleRealWidth_m;
+extern bool  autoZoom_enabled, audioAlarm_enabled;
+extern float sideMargin_m, maxWidth_m;
+extern uint16_t sensorTimeout_ms;
+extern uint8_t  sensorExpectedMask;
+extern uint16_t steerCanId;
+extern uint16_t wheelbase_cm;
+extern uint16_t speedCanId;
+extern uint8_t  speedOptions;
+extern uint8_t  clutterOptions;
+extern uint8_t  occOptions;
+extern uint8_t  markerPoolSize;
+extern uint8_t  displayOptions;
+extern uint8_t  refreshClass[ELEMENT_COUNT];
+extern uint16_t elementBudget_Bps;
+
+// Ayarlardan türetilen tamsayı eşikler (cm) - applySettings() ile güncellenir
+extern int16_t warningZone_cm, dangerZone_cm, vehicleWidth_cm, halfCorridor_cm;
+
+// Buzzer Durumu
+extern bool buzzerShouldBeActive;
+extern bool buzzerIsOn;
+extern unsigned long lastBuzzerToggleTime;
+extern int  currentBeepInterval;
+
+// Seri Konsol
+extern char consoleBuffer[CONSOLE_BUFFER_SIZE];
+extern int  consoleLength;
+
+// Trafik İstatistikleri (slot = identifier - RADAR_ID_FIRST)
+// Aralık ortalaması ve jitter Q4 (1/16 ms) formatında, kayan ortalama ile tutulur.
+struct SlotStats {
+  uint32_t frames;          // Toplam çerçeve
+  uint32_t invalidFrames;   // data[7] bit0 = 1 olan çerçeveler
+  uint32_t lastSeen_ms;     // Son çerçeve zamanı
+  uint16_t meanInterval_q4; // Ortalama geliş aralığı
+  uint16_t jitter_q4;       // Ortalama sapma (RFC 3550 tarzı)
+};
+extern SlotStats     slotStats[RADAR_SLOT_COUNT];
+extern uint32_t      canFramesOther;  // Radar aralığı dışındaki çerçeveler
+extern unsigned long statsResetTime;
+
+// Sensör Denetimi (Heartbeat)
+// Çerçeve yolunda sadece zaman damgası yazılır; zaman aşımı kontrolü periyodik yapılır.
+extern uint32_t      sensorLastSeen_ms[RADAR_SENSOR_COUNT];
+extern uint8_t       sensorFaultMask;
+extern unsigned long lastSupervisionTime;
+extern bool          statusPending;  // Sensör olayı: durum metni CAN yolunda değil, sonraki karede yazılır
+
+// Hedef Deposu (Structure-of-Arrays, indeks = slot)
+// Her alan ayrı dizide tutulur; çekirdekler tüm diziyi tek geçişte işler.
+const uint8_t TGT_ACTIVE      = 0x01; // Geçerli ve süresi dolmamış
+const uint8_t TGT_FRESH       = 0x02; // Yeni ham veri var, decode bekliyor
+const uint8_t TGT_TRACKED     = 0x04; // Önceki konum mevcut (hız hesaplanabilir)
+const uint8_t TGT_IN_CORRIDOR = 0x08; // Araç koridoru içinde
+const uint8_t TGT_STATIC      = 0x10; // Zemine göre hareketsiz (ego-hareket düzeltmeli)
+
+struct TargetStore {
+  uint8_t  rawRange[RADAR_SLOT_COUNT];   // data[0]
+  uint8_t  rawAngle[RADAR_SLOT_COUNT];   // data[1]
+  uint8_t  rawX[RADAR_SLOT_COUNT];       // data[2]
+  uint8_t  rawY[RADAR_SLOT_COUNT];       // data[3]
+  int16_t  r_cm[RADAR_SLOT_COUNT];       // Polar mesafe
+  int16_t  x_cm[RADAR_SLOT_COUNT];       // İleri
+  int16_t  y_cm[RADAR_SLOT_COUNT];       // Yanal
+  int8_t   angle_deg[RADAR_SLOT_COUNT];
+  int16_t  vx_cms[RADAR_SLOT_COUNT];     // İleri hız (cm/s, kayan ortalama)
+  int16_t  vy_cms[RADAR_SLOT_COUNT];     // Yanal hız (cm/s, kayan ortalama)
+  int16_t  groundVx_cms[RADAR_SLOT_COUNT]; // Zemine göre ileri hız
+  int16_t  groundVy_cms[RADAR_SLOT_COUNT]; // Zemine göre yanal hız
+  uint8_t  zone[RADAR_SLOT_COUNT];       // ZoneLevel
+  uint8_t  flags[RADAR_SLOT_COUNT];
+  uint32_t seen_ms[RADAR_SLOT_COUNT];    // Son çerçeve zamanı
+  uint32_t decoded_ms[RADAR_SLOT_COUNT]; // Son decode edilen çerçevenin zamanı
+  int16_t  cell[RADAR_SLOT_COUNT];       // Araç ızgarası hücresi, -1 = ızgara dışı
+};
+extern TargetStore targets;
+
+// Karşılaştırma tabanı: aynı alanlar hedef başına tek struct (array-of-structs) düzeninde.
+// Sadece BENCH ve masaüstü testi kullanır; çekirdekler SoA sürümleriyle aynı sonucu verir.
+struct TargetRecord {
+  uint8_t  rawRange, rawAngle, rawX, rawY;
+  int16_t  r_cm, x_cm, y_cm;
+  int8_t   angle_deg;
+  int16_t  vx_cms, vy_cms, groundVx_cms, groundVy_cms;
+  uint8_t  zone, flags;
+  uint32_t seen_ms, decoded_ms;
+  int16_t  cell;
+};
+
+// Kavisli Koridor (süpürülen alan): merkez (0, centerY) etrafında iç/dış yarıçap halkası.
+// Kareler önceden hesaplanır; hedef başına test 2 çarpma + 2 karşılaştırma.
+struct PathModel {
+  bool    curved;
+  int32_t centerY_cm;
+  int32_t innerSq_cm2;
+  int32_t outerSq_cm2;
+};
+extern PathModel     pathModel;
+extern int16_t       steeringAngle_ddeg;
+extern unsigned long steeringSeen_ms;
+
+// Ego-Hareket
+extern int16_t       egoSpeed_cms;
+extern int16_t       egoYaw_mrads;  // mrad/s
+extern unsigned long speedSeen_ms;
+extern bool          egoValid;      // Hız verisi güncel (parti başında belirlenir)
+extern int16_t       zoneSpeedMargin_cm;
+
+// Poligon Bölgeleri: düzenlemede tarama satırı (kenar tablosu) ile ızgaraya işlenir,
+// sınıflandırma hedef başına tek tablo okumasıdır (hücre başına 2 bit seviye).
+struct PolyZone {
+  uint8_t level;                    // ZoneLevel (1..3), 0 = boş
+  uint8_t count;                    // Köşe sayısı (>= 3 ise etkin)
+  int16_t x_cm[POLY_VERTEX_MAX];    // İleri
+  int16_t y_cm[POLY_VERTEX_MAX];    // Yanal
+};
+extern PolyZone polyZones[POLY_ZONE_MAX];
+extern uint8_t  zoneGrid[GRID_CELLS / 4];
+extern bool     polyZonesActive;
+
+// Karmaşa Maskesi: hücre başına 1 bit, ingestCanFrame() içinde ham baytlardan tek okuma.
+extern uint8_t       clutterMask[GRID_CELLS / 8];
+extern uint8_t       clutterHits[GRID_CELLS];  // Sadece öğrenme sırasında kullanılır
+extern bool          clutterLearning;
+extern uint8_t       clutterSamples;
+extern uint8_t       clutterSamplesTarget;
+extern unsigned long clutterNextSample_ms;
+extern uint32_t      clutterRejected;          // Maskelenen radar çerçeveleri
+
+// Doluluk Izgarası: araç çerçevesinde mekânsal hafıza, sorgu O(1)
+extern uint8_t       occupancy[GRID_CELLS];
+extern unsigned long occNextDecay_ms;
+
+// Tahminli Çizim
+// Son çizilen tahmin, aynı slotun bir sonraki çerçevesinde puanlanır.
+struct PredictionStats {
+  uint32_t renders;
+  uint32_t samples;
+  uint32_t horizonSum_ms;
+  uint32_t horizonMax_ms;
+  uint32_t errPredictedSum_cm; // Tahminli konum hatası (L1)
+  uint32_t errHeldSum_cm;      // Tahminsiz (son ölçüm) konum hatası (L1)
+};
+extern bool            prediction_enabled;
+extern PredictionStats predStats;
+extern int             predSlot;
+extern int16_t         predX0_cm, predY0_cm, predVx_cms, predVy_cms;
+extern uint32_t        predT0_ms;
+
+// Marker Havuzu: her marker bir depo slotuna (iz) bağlıdır; iz sürdükçe aynı marker hareket eder.
+// vis sadece atama değiştiğinde gönderilir, değişmeyen özellikler tekrar gönderilmez.
+struct MarkerState {
+  int8_t   slot;    // Bağlı depo slotu, -1 = boş
+  bool     shown;
+  int16_t  x, y;
+  uint8_t  zone;
+};
+extern MarkerState markers[MARKER_POOL_SIZE];
+extern int32_t     lastScene;  // Paketli modda son gönderilen sahne, -1 = yeniden gönder
+extern bool        numericShown;
+
+struct RenderStats {
+  uint32_t frames;
+  uint32_t bytesSum;        // Kare başına gönderilen bayt toplamı
+  uint32_t bytesMax;
+  uint32_t markersSum;      // Kare başına çizilen marker toplamı
+  uint32_t budgetDropped;   // Bütçe nedeniyle çizilmeyen ek hedefler
+  uint32_t latencySum_ms;   // Kare sonunda kuyruğun boşalma süresi = kare ekranda tamamlanana kadar
+  uint32_t latencyMax_ms;
+  uint32_t backlogMax;      // Kare sonunda en yüksek TX kuyruğu (bayt)
+  uint32_t sceneTextBytes;  // Sahne + marker komutları, iki kodlamada (mod ne olursa olsun aynı kareler)
+  uint32_t scenePackedBytes;
+  uint32_t fieldCalls;      // Hedef bilgi alanları: çağrı, bayt ve CPU çevrimi (seçili modda)
+  uint32_t fieldBytesSum;
+  uint32_t fieldCyclesSum;
+  uint32_t markerXYBytes;   // Hareket eden marker'lar: x/y, move ve 20 Hz x/y karşılığı (mod ne olursa olsun)
+  uint32_t markerMoveBytes;
+  uint32_t markerSmoothBytes;
+  uint32_t cmdsSum[RENDERER_COUNT];   // Kare başına Nextion komutu (SceneRenderer)
+  uint32_t cmdFrames[RENDERER_COUNT];
+  uint32_t drawPixels;      // Anlık çizimde silinen (fill) piksel
+  uint32_t drawFullRedraws;
+};
+extern RenderStats   renderStats;
+extern uint32_t      nextionTxBytes;  // sendCommand() ile kuyruğa giren toplam bayt
+extern uint32_t      nextionTxCommands;
+extern uint32_t      frameStartCommands;
+extern bool          refBatch_enabled;
+extern bool          nextionDryRun;   // BENCH: baytlar sayılır, UART'a yazılmaz
+extern bool          nexOutputDropped;  // Yazılamayan komut düştü: hat açılınca ekran önbelleği yenilenir
+extern uint32_t      frameStartBytes;
+
+// Öncelikli çıkış kuyruğu: ekleme sırasında tutulur, en yüksek öncelikli en eski komut önce yazılır.
+// Aynı anahtarı ("rTarget.x", "vis rTarget") bekleyen komutun yerine yenisi geçer.
+struct NexQueued {
+  char     text[NEX_CMD_MAX];
+  uint8_t  len;
+  uint8_t  keyLen;         // 0: anahtarsız (ref_stop, fill, page 0...), üzerine yazılmaz
+  uint8_t  prio;
+  bool     alarm;          // Öncelik kapalıyken de alarm gecikmesi ölçülsün
+  uint32_t queued_ms;
+  uint32_t fifo_ms;        // Kuyruğa girdiğinde sıra ile beklenecek süre (öncelik olmasaydı)
+  uint32_t frameSeq;       // Kare komutu sırası (beginFrame..endFrame), 0 = kare dışı
+};
+extern NexQueued nexQueue[NEX_QUEUE_LEN];
+extern int       nexQueueCount;
+extern int       nexQueuedBytes;
+extern bool      nexPriority_enabled;
+struct QueueStats {
+  uint32_t alarmCmds;
+  uint32_t alarmLatSum_ms;  // Komutun üretilmesinden son baytının hattan çıkmasına
+  uint32_t alarmLatMax_ms;
+  uint32_t alarmFifoMax_ms;
+  uint32_t superseded;
+  uint32_t supersededBytes;
+  uint32_t depthMax;
+  uint32_t forced;          // Kuyruk doluyken hat sınırı beklenmeden yazılan
+  uint32_t frameReorders;   // Kendinden sonra üretilen kare komutundan sonra yazılan kare komutu (0 olmalı)
+};
+extern QueueStats queueStats;
+extern uint32_t   nexFrameSeq;         // Son kuyruğa giren kare komutunun sırası
+extern uint32_t   nexFrameSeqWritten;  // Hatta yazılan en büyük kare sırası
+extern bool       nexFrameOpen;        // beginFrame..endFrame arası
+extern uint8_t    nexFramePrio;        // Açık karenin önceliği (alarm komutuyla yükselir)
+extern bool       nexFrameAlarm;       // Açık karede alarm komutu üretildi
+extern uint32_t   nexFrameAlarm_ms;    // Karedeki ilk alarm komutunun zamanı
+extern bool       nexFrameClosing;     // ref_star kuyruğa giriyor
+
+// Uyarlamalı çizim hızı
+extern bool          renderRate_auto;
+extern bool          renderDirty;       // Son çizimden sonra yeni tarama geldi
+extern uint32_t      renderInterval_ms;
+extern uint8_t       renderLod;
+extern uint8_t       renderedZone;
+extern bool          fieldsParked;      // Düşük ayrıntıda alanlar "--" yapıldı
+extern unsigned long lastRender_ms;
+extern uint32_t      nextionWireBytes;  // UART'a yazılan (yerine geçenler hariç) bayt
+extern uint32_t      renderCycle_ms;    // Ölçülen çizim aralığı (oran kontrolü yoksa radar taraması)
+
+// Anlık çizim: ekranda olan ve bu karede istenen şekiller (circle: x,y merkez, w yarıçap; line: w,h bitiş)
+struct DrawPrim {
+  uint8_t  kind;
+  int16_t  x, y, w, h;
+  uint16_t color;
+};
+extern DrawPrim drawnPrims[DRAW_PRIM_MAX];
+extern DrawPrim framePrims[DRAW_PRIM_MAX];
+extern int      drawnCount;
+extern int      frameCount;
+extern bool     drawFullPending;  // Ekran içeriği bilinmiyor: sonraki kare cls ile başlar
+
+// Mesafe profili halka tamponu (waveform değerleri) ve addt aktarım durumu
+enum ProfileState : uint8_t { PROFILE_IDLE, PROFILE_WAIT_READY, PROFILE_SENDING };
+extern uint8_t       profileRing[PROFILE_POINTS];
+extern int           profileHead;    // Sıradaki yazma konumu
+extern int           profileFilled;  // Tampondaki nokta (en fazla PROFILE_POINTS)
+extern int           profileUnsent;  // Ekrana henüz aktarılmamış son noktalar
+extern int           profileBurstStart;
+extern int           profileBurstLen;
+extern ProfileState  profileState;
+extern unsigned long profileNext_ms;
+extern unsigned long profileStart_ms;
+struct ProfileStats {
+  uint32_t bursts;
+  uint32_t points;
+  uint32_t bytes;        // addt komutu + ham veri
+  uint32_t addBytes;     // Aynı noktalar "add sProfile.id,0,v" ile gönderilseydi
+  uint32_t timeouts;
+  uint32_t deferred;     // Alarm nedeniyle ertelenen aktarım
+  uint32_t maxHold_ms;   // Kuyruğun bekletildiği en uzun süre
+  uint32_t dropped;      // Aktarım sürerken yer olmadığı için düşen komut
+};
+extern ProfileStats  profileStats;
+extern uint32_t      scanSlotsSeen[RADAR_SLOT_COUNT / 32];  // Son profil örneğinden beri çerçevesi gelen slotlar
+
+// Şekil sahnesinin (RENDER DRAW / RENDER TFT) çıkışı: kare farkından sonra tam temizlik, kirli dikdörtgen
+// silme ve şekil çizme. Bölge tabanlı çıkış (piksel) her bölgeyi tüm şekillerle yeniden rasterize eder;
+// sadece yeni/değişen şekilleri ister. Bileşen modu (rTarget, rVehicle, page0.pic) bunu kullanmaz.
+struct SceneBackend {
+  void (*begin)(bool alarm);  // Kare başı; alarm: karede kırmızı dolgu var
+  void (*clear)();
+  void (*erase)(int x0, int y0, int x1, int y1);
+  void (*draw)(const DrawPrim& p);
+  void (*finish)();
+  bool regionBased;
+};
+
+// Piksel hedefi: bölge başına pencere açılır, pencere şeritler halinde satır satır doldurulur.
+// band() RASTER_BAND_PIXELS'lik yazılabilir tampon verir (gerekirse önceki gönderimi bekler);
+// push() doldurulan şeridi gönderir. Pikseller RGB565, büyük uçlu (SPI sırası).
+struct PixelSink {
+  uint16_t* (*band)();
+  void (*window)(int x0, int y0, int x1, int y1);
+  void (*push)(uint16_t* buf, int pixels);
+};
+extern const PixelSink* pixelSink;  // Yoksa RENDER TFT seçilemez
+
+struct RasterStats {
+  uint32_t pixels;      // Piksel hedefine gönderilen piksel
+  uint32_t regions;
+  uint32_t flushMax_us; // Rasterize + gönderim (TFT'de DMA arka planda sürer)
+  uint32_t dmaWaits;    // TFT: şerit tamponu hâlâ gönderiliyordu
+};
+extern RasterStats       rasterStats;
+
+struct RateControl {
+  unsigned long last_ms;
+  unsigned long lodHoldUntil_ms;
+  uint32_t wireBytes0;
+  uint32_t wireBps;        // Son pencerede hatta verilen bayt/s
+  uint32_t frameBytesAvg;  // Kare baytı, üstel ortalama (1/4)
+  uint32_t fieldBytesAvg;
+  uint32_t deferred;       // Aralık dolmadığı için sonraya kalan taramalar
+  uint32_t lodDowns;
+  uint32_t lodUps;
+};
+extern RateControl rateCtl;
+
+// Yenileme sınıfları: son gönderilen değer/zaman ve bayt kovası
+extern int32_t       elementValue[ELEMENT_COUNT];
+extern unsigned long elementSent_ms[ELEMENT_COUNT];
+extern int32_t       elementTokens_mB;  // Mili-bayt: düşük bütçede kesir kaybolmaz
+extern unsigned long elementRefill_ms;
+struct ElementStats {
+  uint32_t sent[ELEMENT_COUNT];
+  uint32_t bytes[ELEMENT_COUNT];
+  uint32_t budgetSkips;    // Zamanı gelip bütçe yetmediği için sonraya kalan
+};
+extern ElementStats elementStats;
+
+// -------------------------------------------------------------------------------------------------
+// ARAÇ IZGARASI YARDIMCILARI
+// -------------------------------------------------------------------------------------------------
+static inline int gridCellFromRaw(uint8_t rawX, uint8_t rawY) {
+  int cy = (int)rawY - 128 + GRID_Y_CELLS / 2;
+  if (rawX >= GRID_X_CELLS || cy < 0 || cy >= GRID_Y_CELLS) return -1;
+  return cy * GRID_X_CELLS + rawX;
+}
+
+static inline bool clutterMaskedAt(int cell) {
+  return clutterMask[cell >> 3] & (1 << (cell & 7));
+}
+
+static inline void occupancyHit(int cell) {
+  int v = occupancy[cell] + OCC_HIT;
+  occupancy[cell] = v > 255 ? 255 : v;
+}
+
+static inline uint8_t zoneLevelAt(int cell) {
+  return (zoneGrid[cell >> 2] >> ((cell & 3) * 2)) & 0x03;
+}
+
+// -------------------------------------------------------------------------------------------------
+// PAKETLİ PROTOKOL YARDIMCILARI
+// -------------------------------------------------------------------------------------------------
+static inline uint32_t packMarker(int x, int y, uint8_t zone, bool visible) {
+  return (uint32_t)x | ((uint32_t)y << PACK_Y_SHIFT) | ((uint32_t)zone << PACK_ZONE_SHIFT) |
+         ((uint32_t)visible << PACK_VIS_SHIFT);
+}
+
+static inline uint32_t packScene(int picId, int vehicleX_px, int vehicleW_px) {
+  return (uint32_t)picId | ((uint32_t)vehicleX_px << SCENE_VEH_X_SHIFT) | ((uint32_t)vehicleW_px << SCENE_VEH_W_SHIFT);
+}
+
+// Karşılaştırma için: "<önek><sayı>" + 3 x 0xFF
+static inline uint32_t commandBytes(const char* prefix, long value) {
+  char digits[12];
+  return strlen(prefix) + snprintf(digits, sizeof(digits), "%ld", value) + 3;
+}
+
+// "<marker bileşeni/değişkeni><sonek><sayı>" + 3 x 0xFF (rTarget, rTarget1..3; vT0..vT3)
+static inline uint32_t markerCommandBytes(const char* name, const char* suffix, long value) {
+  return strlen(name) + commandBytes(suffix, value);
+}
+
+// (num / den + 0.5) sıfıra doğru kesilmiş: float sürümdeki (int)(v + 0.5) ile birebir aynı.
+static inline int32_t roundDiv(int32_t num, int32_t den) {
+  return (2 * num + den) / (2 * den);
+}
+
+// -------------------------------------------------------------------------------------------------
+// PROTOTİPLER
+// -------------------------------------------------------------------------------------------------
+void sendCommand(String cmd, uint8_t prio = NEX_PRIO_NORMAL);
+void writeToNextion(const char* text, int len);
+void pumpNextionQueue();
+bool nextionCanWrite();
+int  nextQueued();
+void writeNextQueued();
+void removeQueued(int q);
+void beginNextionFrame();
+void endNextionFrame();
+void raiseNextionFrame();
+int  uartTxBacklog();
+void loadSettingsFromEEPROM();
+void saveSettingsToEEPROM();
+void resetToDefaults();
+void handleNextionInput();
+void processNextionMessage(int length);
+void onNextionPage(uint8_t page);
+void invalidateDisplayCache();
+void trackCommandSent();
+void clearNextionAcks();
+void onNextionReturn(uint8_t code);
+void expireNextionAcks(unsigned long now);
+int  nextionCredits();
+void superviseNextionLink(unsigned long now);
+void startLinkResync(bool rebooted);
+void stepLinkResync();
+void resyncMainPage(int nearest);
+void handleDetection(int i);
+void clearDetection();
+void updateVehicleDisplay(int gridWidth_cm);
+int  vehicleCommandBytes(int x_px, int w_px);
+void vehicleGeometry(int gridWidth_cm, int& x_px, int& w_px);
+void updateScene(int picId, int gridWidth_cm, int excludeCell);
+void applyDisplayProtocol();
+void updateTargetDisplay(int k, int x, int y, uint8_t zone, uint32_t move_ms = 0);
+uint32_t moveDuration_ms();
+void beginFrame();
+void endFrame();
+int  assignMarkers(int primary, int* sel);
+void releaseMarker(int k);
+int  markerOf(int slot);
+void updateTextDisplays(int radius_cm, int angle, int x_cm, int y_cm);
+void clearFieldDisplays();
+bool elementDue(int el, int32_t value);
+bool spendElement(int el, int32_t value, int cost);
+void forgetElements();
+void runFieldBenchmark();
+void addDrawPrim(uint8_t kind, int x, int y, int w, int h, int color);
+void addDrawScene(int picId, int gridWidth_cm);
+void flushDrawFrame();
+SceneRenderer sceneRenderer();
+#if DISPLAY_TFT == 1
+bool tftBegin();
+#endif
+void recordRangeProfile(int nearest);
+void stepRangeProfile(unsigned long now);
+void onProfileReturn(uint8_t code);
+void endRangeProfile();
+void dropNextionCommand();
+void recoverDroppedOutput();
+bool startsNewScan(const twai_message_t& msg);
+void runTargetKernels();
+void mapTargetToPixels(int x_cm, int y_cm, int gridWidth_cm, int& px, int& py);
+String formatMeters(int cm);
+int  nextionTxBacklog();
+uint32_t nextionTxLatency_ms();
+void updateRenderRate(unsigned long now);
+void scorePrediction(int i, int16_t x_cm, int16_t y_cm);
+void applySettings();
+unsigned long fixedPointPixelMismatches(int zoom);
+unsigned long fixedPointThresholdMismatches();
+#if SELFTEST_FIXEDPOINT == 1
+void selfTestFixedPoint();
+#endif
+void sendSettingsToNextion();
+void sendSettingToNextion(int item);
+void handleBuzzer();
+void handleSerialConsole();
+void processConsoleCommand(const char* cmd);
+void updateSlotStats(int slot, bool valid, unsigned long now);
+void resetTrafficStats();
+void dumpTrafficStats();
+void markSensorAlive(int sensor, unsigned long now);
+void superviseSensors();
+int32_t statusCode();
+void updateStatusText();
+void ingestCanFrame(const twai_message_t& msg, unsigned long now);
+void expireTargets(unsigned long now);
+void decodeTargets();
+void testCorridor();
+void classifyZones();
+int  findNearestTarget();
+void updateBuzzerFromTargets();
+void dumpTargets();
+void ingestSteeringFrame(const twai_message_t& msg, unsigned long now);
+void updatePathModel();
+void ingestSpeedFrame(const twai_message_t& msg, unsigned long now);
+void compensateEgoMotion();
+void rebuildZoneGrid();
+void dumpPolyZones();
+void startClutterLearning(int seconds);
+void learnClutter(unsigned long now);
+void finishClutterLearning();
+int  countClutterCells();
+void decayOccupancy(unsigned long now);
+void drawOccupancyOverlay(int gridWidth_cm, int excludeCell);
+void dumpOccupancyMap();
+void runKernelBenchmark();
+void copyTargetsToRecords(TargetRecord* t);
+void testCorridorRecords(TargetRecord* t, bool curved);
+void classifyZonesRecords(TargetRecord* t);
+int  countRecordMismatches(const TargetRecord* t);
@@ -22,142 +22,87 @@
  * =================================================================================================
  */
 
-#include "driver/gpio.h"
-#include "driver/twai.h"
-#include <math.h>
-#include <HardwareSerial.h>
-#include <EEPROM.h>
-
-// -------------------------------------------------------------------------------------------------
-// DEBUG AYARLARI
-// -------------------------------------------------------------------------------------------------
-#define DEBUG_CAN      0
-#define DEBUG_NEXTION  1  // Komutları görmek için açık
-#define DEBUG_RADAR    0
-#define DEBUG_BUZZER   0
-#define DEBUG_EEPROM   1
-
-#if DEBUG_NEXTION == 1
-  #define NEXTION_PRINTF(...) Serial.printf(__VA_ARGS__)
-#else
-  #define NEXTION_PRINTF(...)
-#endif
-#if DEBUG_RADAR == 1
-  #define RADAR_PRINTF(...) Serial.printf(__VA_ARGS__)
-  #define RADAR_PRINTLN(x) Serial.println(x)
-#else
-  #define RADAR_PRINTF(...)
-  #define RADAR_PRINTLN(x)
-#endif
-#if DEBUG_BUZZER == 1
-  #define BUZZER_PRINTLN(x) Serial.println(x)
-#else
-  #define BUZZER_PRINTLN(x)
-#endif
-#if DEBUG_EEPROM == 1
-  #define EEPROM_PRINTLN(x) Serial.println(x)
-#else
-  #define EEPROM_PRINTLN(x)
-#endif
-#if DEBUG_CAN == 1
-  #define CAN_PRINTF(...) Serial.printf(__VA_ARGS__)
-#else
-  #define CAN_PRINTF(...)
-#endif
-
-// -------------------------------------------------------------------------------------------------
-// DONANIM VE SABİTLER
-// -------------------------------------------------------------------------------------------------
-#define CAN_TX_PIN GPIO_NUM_5
-#define CAN_RX_PIN GPIO_NUM_4
-#define BUZZER_PIN 25
-
-const long SERIAL_MONITOR_BAUD = 115200;
-const long NEXTION_BAUD        = 9600;
-const int  RX_BUFFER_SIZE      = 64;
-
-// --- EEPROM ---
-#define EEPROM_SIZE 64
-const int EEPROM_MAGIC_KEY    = 124;
-const int ADDR_MAGIC_KEY      = 0;
-const int ADDR_WARN_ZONE      = 4;
-const int ADDR_DANGER_ZONE    = 8;
-const int ADDR_VEHICLE_WIDTH  = 12;
-// ADDR_PASSWORD artik ESP32 tarafindan aktif kullanilmiyor ama yerini koruyoruz
-const int ADDR_PASSWORD       = 16; 
-const int ADDR_AUTOZOOM_EN    = 44;
-const int ADDR_AUDIOALARM_EN  = 45;
-const int ADDR_SIDE_MARGIN    = 48;
-const int ADDR_MAX_WIDTH      = 52;
-
-// Varsayılanlar
-const float DEFAULT_WARNING_ZONE_M    = 5.0;
-const float DEFAULT_DANGER_ZONE_M     = 2.0;
-const float DEFAULT_VEHICLE_WIDTH_M   = 2.0; 
-const float DEFAULT_SIDE_MARGIN_M     = 0.5;
-const float DEFAULT_MAX_WIDTH_M       = 10.0;
-const bool  DEFAULT_AUTOZOOM_EN       = true;
-const bool  DEFAULT_AUDIOALARM_EN     = true;
-
-// Ekran Özellikleri
-const int   SCREEN_WIDTH_PX       = 272;
-const int   SCREEN_HEIGHT_PX      = 480;
-const int   TARGET_OBJECT_SIZE_PX = 30;
-const int   VEHICLE_HEIGHT_PX     = 10;
-const int   VEHICLE_COLOR         = 31;
-
-// Nextion Resim ID'leri
-const int PIC_ID_SAFE    = 4;  // 10m
-const int PIC_ID_WARNING = 1;  // 8m
-const int PIC_ID_DANGER  = 2;  // 6m
-const int PIC_ID_ALARM   = 0;  // 4m
-
-// Renkler
-const int COLOR_RED      = 63488;
-const int COLOR_ORANGE   = 64512;
-const int COLOR_YELLOW   = 65504;
-const int COLOR_GREEN    = 2016;
-
-// Buzzer
-const float SOLID_TONE_DISTANCE_M   = 0.75;
-const int   BEEP_ON_DURATION_MS     = 60;
-const int   BEEP_INTERVAL_YELLOW_MS = 400;
-const int   BEEP_INTERVAL_ORANGE_MS = 200;
-const int   BEEP_INTERVAL_RED_MS    = 80;
+#include "radar.h"
 
 // -------------------------------------------------------------------------------------------------
 // GLOBAL DEĞİŞKENLER
 // -------------------------------------------------------------------------------------------------
-HardwareSerial SerialNextion(2);
-bool targetVisible = false;
-char rxBuffer[RX_BUFFER_SIZE];
+// Nextion girişi ve sayfa takibi
+bool          targetVisible      = false;
+int           renderedTarget     = -1;
+char          rxBuffer[RX_BUFFER_SIZE];
+int           rxLength           = 0;
+unsigned long rxLast_ms          = 0;
+uint8_t       nextionPage        = NEX_PAGE_MAIN;
+bool          pageResyncPending  = false;
+unsigned long pagePollNext_ms    = 0;
+int           alarmTarget        = -1;
+PageStats     pageStats;
 
 // Ayar Değişkenleri
 float warningZone_m, dangerZone_m, vehicleRealWidth_m;
 bool  autoZoom_enabled, audioAlarm_enabled;
 float sideMargin_m, maxWidth_m;
+uint16_t sensorTimeout_ms;
+uint8_t  sensorExpectedMask;
+uint16_t steerCanId;
+uint16_t wheelbase_cm;
+uint16_t speedCanId;
+uint8_t  speedOptions;
+uint8_t  clutterOptions;
+uint8_t  occOptions;
+uint8_t  markerPoolSize;
+uint8_t  displayOptions;
+uint8_t  refreshClass[ELEMENT_COUNT];
+uint16_t elementBudget_Bps;
+int16_t  warningZone_cm, dangerZone_cm, vehicleWidth_cm, halfCorridor_cm;
 
-// Buzzer Durumu
-bool buzzerShouldBeActive = false;
-bool buzzerIsOn           = false;
+// Buzzer ve seri konsol
+bool          buzzerShouldBeActive = false;
+bool          buzzerIsOn           = false;
 unsigned long lastBuzzerToggleTime = 0;
-int  currentBeepInterval  = BEEP_INTERVAL_YELLOW_MS;
+int           currentBeepInterval  = BEEP_INTERVAL_YELLOW_MS;
+char          consoleBuffer[CONSOLE_BUFFER_SIZE];
+int           consoleLength        = 0;
 
-// -------------------------------------------------------------------------------------------------
-// PROTOTİPLER
-// -------------------------------------------------------------------------------------------------
-void sendCommand(String cmd);
-void loadSettingsFromEEPROM();
-void saveSettingsToEEPROM();
-void resetToDefaults();
-void handleNextionInput();
-void handleDetection(const twai_message_t& msg);
-void clearDetection();
-void updateVehicleDisplay(float currentMaxGridXMeters);
-void updateTargetDisplay(int x, int y, int color);
-void updateTextDisplays(float radius, int angle, float x_m, float y_m);
-void sendSettingsToNextion();
-void handleBuzzer();
+// Trafik istatistikleri ve sensör denetimi
+SlotStats     slotStats[RADAR_SLOT_COUNT];
+uint32_t      canFramesOther      = 0;
+unsigned long statsResetTime      = 0;
+uint32_t      sensorLastSeen_ms[RADAR_SENSOR_COUNT];
+uint8_t       sensorFaultMask     = 0;
+unsigned long lastSupervisionTime = 0;
+bool          statusPending       = false;
+
+// Çizim motoru
+bool            prediction_enabled = true;
+PredictionStats predStats;
+int             predSlot = -1;
+int16_t         predX0_cm, predY0_cm, predVx_cms, predVy_cms;
+uint32_t        predT0_ms;
+MarkerState     markers[MARKER_POOL_SIZE];
+int32_t         lastScene          = -1;
+bool            numericShown       = false;
+RenderStats     renderStats;
+uint32_t        frameStartCommands = 0;
+uint32_t        frameStartBytes    = 0;
+bool            refBatch_enabled   = true;
+
+// Uyarlamalı çizim hızı ve yenileme sınıfları
+bool          renderRate_auto   = true;
+bool          renderDirty       = false;
+uint32_t      renderInterval_ms = RENDER_MIN_MS;
+uint8_t       renderLod         = LOD_TEXT;
+uint8_t       renderedZone      = ZONE_SAFE;
+bool          fieldsParked      = false;
+unsigned long lastRender_ms     = 0;
+uint32_t      renderCycle_ms    = 100;
+RateControl   rateCtl;
+int32_t       elementValue[ELEMENT_COUNT];
+unsigned long elementSent_ms[ELEMENT_COUNT];
+int32_t       elementTokens_mB  = 0;
+unsigned long elementRefill_ms  = 0;
+ElementStats  elementStats;
 
 // -------------------------------------------------------------------------------------------------
 // SETUP
@@ -165,17 +110,35 @@ void handleBuzzer();
 void setup() {
   pinMode(BUZZER_PIN, OUTPUT);
   digitalWrite(BUZZER_PIN, LOW);
+#if DEBUG_TIMING == 1
+  pinMode(TIMING_FRAME_PIN, OUTPUT);
+  pinMode(TIMING_TX_PIN, OUTPUT);
+#endif
   
   Serial.begin(SERIAL_MONITOR_BAUD);
+  SerialNextion.setTxBufferSize(NEXTION_TX_BUFFER_SIZE);
   SerialNextion.begin(NEXTION_BAUD, SERIAL_8N1, 16, 17);
   
   Serial.println("\n======================================================");
   Serial.println("   ESP32 RADAR SİSTEMİ - v3.7.0 (Nextion Auth)");
   Serial.println("======================================================");
+  Serial.printf("[INFO] Ekran profili: %dx%d\n", SCREEN_WIDTH_PX, SCREEN_HEIGHT_PX);
 
   loadSettingsFromEEPROM();
+#if DISPLAY_TFT == 1
+  tftBegin();
+#endif
+  if (!pixelSink) displayOptions &= ~DISPLAY_OPT_TFT;
+  resetTrafficStats();
+#if SELFTEST_FIXEDPOINT == 1
+  selfTestFixedPoint();
+#endif
+  for (int i = 0; i < RADAR_SENSOR_COUNT; i++) sensorLastSeen_ms[i] = millis();
+  for (int k = 0; k < MARKER_POOL_SIZE; k++) markers[k].slot = -1;
+  forgetElements();
 
   twai_general_config_t g_config = TWAI_GENERAL_CONFIG_DEFAULT((gpio_num_t)CAN_TX_PIN, (gpio_num_t)CAN_RX_PIN, TWAI_MODE_NORMAL);
+  g_config.rx_queue_len = CAN_RX_QUEUE_LEN;
   twai_timing_config_t t_config = TWAI_TIMING_CONFIG_500KBITS();
   twai_filter_config_t f_config = TWAI_FILTER_CONFIG_ACCEPT_ALL();
   
@@ -193,200 +156,1066 @@ void setup() {
 // -------------------------------------------------------------------------------------------------
 void loop() {
   handleNextionInput();
+  handleSerialConsole();
+  pumpNextionQueue();
 
+  // İlk çerçeveyi bekle, sonra kuyrukta biriken tüm çerçeveleri beklemeden boşalt
   twai_message_t message;
-  bool detectionThisCycle = false;
-  
-  if (twai_receive(&message, pdMS_TO_TICKS(50)) == ESP_OK) {
-    if (message.identifier >= 0x310 && message.identifier <= 0x38F) {
-      bool validDetection = !(message.data[7] & 0b00000001); 
-      if (validDetection) {
-        detectionThisCycle = true;
-        handleDetection(message);
-      }
+  TickType_t waitTicks = pdMS_TO_TICKS(50);
+  int framesThisCycle = 0;
+
+  while (framesThisCycle < CAN_DRAIN_MAX && twai_receive(&message, waitTicks) == ESP_OK) {
+    if (startsNewScan(message)) {  // Önceki tarama bu çerçeve üzerine yazılmadan işlenir, profile bir nokta
+      runTargetKernels();
+      recordRangeProfile(findNearestTarget());
     }
+    ingestCanFrame(message, millis());
+    framesThisCycle++;
+    waitTicks = 0;
+  }
+
+  // Toplu işleme: tüm depo tek geçişte
+  expireTargets(millis());
+  if (clutterLearning) learnClutter(millis());
+  decayOccupancy(millis());
+  if (framesThisCycle > 0) {
+    renderDirty = true;
+    runTargetKernels();
+  }
+  updateBuzzerFromTargets();
+
+  int nearest = findNearestTarget();
+
+  // Ayar sayfalarındayken sadece alarm seviyesi hedef ana sayfaya döndürür
+  if (nextionPage != NEX_PAGE_MAIN && alarmTarget >= 0 && targets.zone[alarmTarget] == ZONE_ALARM) {
+    sendCommand("page 0", NEX_PRIO_ALARM);
+    pageStats.alarmReturns++;
+    onNextionPage(NEX_PAGE_MAIN);
   }
 
-  if (!detectionThisCycle && targetVisible) {
+  expireNextionAcks(millis());
+  superviseNextionLink(millis());
+  updateRenderRate(millis());
+  bool creditsLeft = nextionCredits() > 0;
+  if (creditsLeft && profileState == PROFILE_IDLE) recoverDroppedOutput();
+
+  if (nextionPage != NEX_PAGE_MAIN) {
+    if (framesThisCycle > 0 && nearest >= 0) pageStats.suppressed++;
+  } else if (!creditsLeft) {
+    if (framesThisCycle > 0 || (nearest < 0 && targetVisible)) flowStats.paused++; // Kare atlanır, sonra tam kare
+  } else if (pageResyncPending) {
+    resyncMainPage(nearest);
+  } else if (nearest >= 0) {
+    // Hedef ya da bölge değişimi beklemez; yeni taramalar çizim aralığı dolunca çizilir
+    bool urgent = nearest != renderedTarget || targets.zone[nearest] != renderedZone;
+    bool due    = !renderRate_auto || millis() - lastRender_ms >= renderInterval_ms;
+    if (urgent || (renderDirty && due)) handleDetection(nearest);
+    else if (framesThisCycle > 0) rateCtl.deferred++;
+  } else if (targetVisible) {
     clearDetection();
+  } else if (statusPending && elementDue(EL_STATUS, statusCode())) {
+    beginFrame();  // Hedef yokken sensör olayı: sadece durum metni
+    updateStatusText();
+    endFrame();
+  }
+
+  if (creditsLeft && (long)(millis() - pagePollNext_ms) >= 0) {
+    pagePollNext_ms = millis() + NEXTION_PAGE_POLL_MS;
+    sendCommand("sendme");  // Kareler arasında sırasıyla; LOW'da dolu hatta hiç çıkmaz, hat kopmuş sanılır
   }
+  if (creditsLeft) stepLinkResync();
+  if (creditsLeft) stepRangeProfile(millis());
 
+  superviseSensors();
   handleBuzzer();
+  pumpNextionQueue();
+#if DEBUG_TIMING == 1
+  if (nextionTxBacklog() == 0) TIMING_SET(TIMING_TX_PIN, LOW);
+#endif
 }
 
 // -------------------------------------------------------------------------------------------------
 // HABERLEŞME (Nextion -> ESP32)
 // -------------------------------------------------------------------------------------------------
-void sendCommand(String cmd) {
-  SerialNextion.print(cmd);
-  SerialNextion.write(0xFF);
-  SerialNextion.write(0xFF);
-  SerialNextion.write(0xFF);
+// Bloklamayan okuma: baytlar tampona eklenir, mesaj 0xFF sonlandırıcıda (ya da sonlandırıcısız
+// gönderen eski HMI için NEXTION_RX_IDLE_MS sessizlikte) tamamlanır. Ardışık 0xFF'ler atlanır.
+void handleNextionInput() {
+  while (SerialNextion.available()) {
+    int c = SerialNextion.read();
+    rxLast_ms = millis();
+    if (c == 0xFF) {
+      if (rxLength > 0) processNextionMessage(rxLength);
+      rxLength = 0;
+      continue;
+    }
+    if (rxLength < RX_BUFFER_SIZE - 1) rxBuffer[rxLength++] = (char)c;
+  }
+
+  if (rxLength > 0 && millis() - rxLast_ms > NEXTION_RX_IDLE_MS) {
+    processNextionMessage(rxLength);
+    rxLength = 0;
+  }
 }
 
+// İkili olaylar (ilk bayt) önce, sonra `strstr` ile metin komutları (SAVE1/2/3, RESETALL).
 // *** NİHAİ ÇÖZÜM: `strstr` ile Akıllı Okuma ve Şifresiz Mantık ***
-void handleNextionInput() {
-  if (SerialNextion.available()) {
-    // Veri okuma ve timeout
-    SerialNextion.setTimeout(50); 
-    int bytesRead = SerialNextion.readBytesUntil((char)0xFF, rxBuffer, RX_BUFFER_SIZE - 1);
-    rxBuffer[bytesRead] = '\0'; 
+void processNextionMessage(int length) {
+  rxBuffer[length] = '\0';
+  uint8_t code = (uint8_t)rxBuffer[0];
 
-    while(SerialNextion.available() && SerialNextion.peek() == 0xFF) {
-      SerialNextion.read();
-    }
+  // Açılış (00 00 00) ve hazır (0x88): ekran varsayılanlara döndü, bildiğimiz her şey geçersiz
+  if (length == 3 && code == NEX_RET_STARTUP && rxBuffer[1] == 0 && rxBuffer[2] == 0) {
+    linkStats.startups++;
+    startLinkResync(true);
+    return;
+  }
+  if (length == 1 && code == NEX_RET_READY) {
+    linkStats.readies++;
+    startLinkResync(true);
+    return;
+  }
+  if (!nextionLinkUp) startLinkResync(false);  // Kopukluktan sonraki ilk mesaj; mesaj yine işlenir
 
-    if (bytesRead == 0) return;
+  if (length == 1 && (code == NEX_RET_ADDT_READY || code == NEX_RET_ADDT_DONE)) {
+    onProfileReturn(code);
+    return;
+  }
 
-    // DEBUG: Gelen veriyi izle
-    // Serial.printf("[RAW]: %s\n", rxBuffer);
+  // Tek baytlık dönüş kodu (0x01 başarı / hata); 0x66 <sayfa>: sendme cevabı (o da bir komut cevabıdır);
+  // 0x65 <sayfa> <bileşen> <olay>: dokunma olayı
+  if (length == 1 && code <= NEX_RET_LAST_CODE) {
+    onNextionReturn(code);
+    return;
+  }
+  if (code == NEX_RET_CURRENT_PAGE && length >= 2) {
+    if (displayOptions & DISPLAY_OPT_FLOW) onNextionReturn(NEX_RET_SUCCESS);
+    onNextionPage((uint8_t)rxBuffer[1]);
+    return;
+  }
+  if (code == NEX_RET_TOUCH_EVENT && length >= 4) {
+    onNextionPage((uint8_t)rxBuffer[1]);
+    return;
+  }
+
+  // DEBUG: Gelen veriyi izle
+  // Serial.printf("[RAW]: %s\n", rxBuffer);
+
+  char* cmdPtr; // Komut işaretçisi
 
-    char* cmdPtr; // Komut işaretçisi
+  // NOT: LOGIN ve SETPASS komutlari kaldirildi. 
+  // Nextion artik kendi hafizasindaki sifreyi kullaniyor.
 
-    // NOT: LOGIN ve SETPASS komutlari kaldirildi. 
-    // Nextion artik kendi hafizasindaki sifreyi kullaniyor.
+  // --- SAVE1 (Bölge Ayarları) ---
+  if ((cmdPtr = strstr(rxBuffer, "SAVE1:")) != NULL) {
+    char* ptr = cmdPtr + 6;
+    char* val1 = strtok(ptr, ",");
+    char* val2 = strtok(NULL, ",");
+    if (val1 && val2) {
+      warningZone_m = atof(val1) / 10.0;
+      dangerZone_m = atof(val2) / 10.0;
+      applySettings();
+      saveSettingsToEEPROM();
+      NEXTION_PRINTF("[SAVE1] Kaydedildi.\n");
+    }
+  }
+  
+  // --- SAVE2 (Araç Ayarları) ---
+  else if ((cmdPtr = strstr(rxBuffer, "SAVE2:")) != NULL) {
+    char* ptr = cmdPtr + 6;
+    char* vMargin = strtok(ptr, ",");
+    char* vWidth = strtok(NULL, ",");
+    char* vMax = strtok(NULL, ",");
+    if (vMargin && vWidth && vMax) {
+      sideMargin_m = atof(vMargin) / 10.0;
+      vehicleRealWidth_m = atof(vWidth) / 10.0;
+      maxWidth_m = atof(vMax) / 10.0;
+      applySettings();
+      saveSettingsToEEPROM();
+      NEXTION_PRINTF("[SAVE2] Kaydedildi.\n");
+    }
+  }
+  
+  // --- SAVE3 (Sistem/Ses) ---
+  else if ((cmdPtr = strstr(rxBuffer, "SAVE3:")) != NULL) {
+    char* ptr = cmdPtr + 6;
+    char* vZoom = strtok(ptr, ",");
+    char* vAudio = strtok(NULL, ",");
 
-    // --- SAVE1 (Bölge Ayarları) ---
-    if ((cmdPtr = strstr(rxBuffer, "SAVE1:")) != NULL) {
-      char* ptr = cmdPtr + 6;
-      char* val1 = strtok(ptr, ",");
-      char* val2 = strtok(NULL, ",");
-      if (val1 && val2) {
-        warningZone_m = atof(val1) / 10.0;
-        dangerZone_m = atof(val2) / 10.0;
-        saveSettingsToEEPROM();
-        NEXTION_PRINTF("[SAVE1] Kaydedildi.\n");
+    if (vZoom && vAudio) {
+      autoZoom_enabled = (atoi(vZoom) == 1);
+      bool newAudioState = (atoi(vAudio) == 1);
+      
+      NEXTION_PRINTF("[SAVE3] Zoom:%d, Ses:%d\n", autoZoom_enabled, newAudioState);
+
+      // MASTER SWITCH: Ses kapatıldıysa Buzzer'ı ANINDA sustur
+      if (!newAudioState) {
+          digitalWrite(BUZZER_PIN, LOW);
+          buzzerIsOn = false;
+          buzzerShouldBeActive = false;
       }
+      
+      audioAlarm_enabled = newAudioState;
+      saveSettingsToEEPROM();
     }
-    
-    // --- SAVE2 (Araç Ayarları) ---
-    else if ((cmdPtr = strstr(rxBuffer, "SAVE2:")) != NULL) {
-      char* ptr = cmdPtr + 6;
-      char* vMargin = strtok(ptr, ",");
-      char* vWidth = strtok(NULL, ",");
-      char* vMax = strtok(NULL, ",");
-      if (vMargin && vWidth && vMax) {
-        sideMargin_m = atof(vMargin) / 10.0;
-        vehicleRealWidth_m = atof(vWidth) / 10.0;
-        maxWidth_m = atof(vMax) / 10.0;
-        saveSettingsToEEPROM();
-        NEXTION_PRINTF("[SAVE2] Kaydedildi.\n");
+  }
+  
+  // --- RESET ---
+  else if (strstr(rxBuffer, "RESETALL") != NULL) {
+    resetToDefaults();
+    NEXTION_PRINTF("[RESET] Fabrika ayarlari.\n");
+  }
+}
+
+// Ana sayfaya dönüşte Nextion page0 bileşenlerini tasarım değerlerine döndürmüştür: önbellek geçersiz.
+void onNextionPage(uint8_t page) {
+  if (page == nextionPage) return;
+  NEXTION_PRINTF("[NEXTION] Sayfa %u -> %u\n", nextionPage, page);
+  if (page == NEX_PAGE_MAIN) pageResyncPending = true;
+  nextionPage = page;
+  pageStats.changes++;
+}
+
+// Ekranda olduğu varsayılan her şeyi unut: sonraki kare her özelliği yeniden gönderir.
+void invalidateDisplayCache() {
+  for (int k = 0; k < MARKER_POOL_SIZE; k++) {
+    markers[k].slot  = -1;
+    markers[k].shown = false;
+  }
+  numericShown   = false;
+  fieldsParked   = false;
+  targetVisible  = false;
+  renderedTarget = -1;
+  profileUnsent  = profileFilled;  // Yeniden yüklenen waveform boş: tüm geçmiş tekrar gönderilir
+  forgetElements();
+  applyDisplayProtocol();
+}
+
+void resyncMainPage(int nearest) {
+  pageResyncPending = false;
+  invalidateDisplayCache();
+  if (nearest >= 0) handleDetection(nearest);
+  else              clearDetection();
+}
+
+// -------------------------------------------------------------------------------------------------
+// SERİ KONSOL (USB Seri Monitör)
+// -------------------------------------------------------------------------------------------------
+void handleSerialConsole() {
+  while (Serial.available()) {
+    char c = (char)Serial.read();
+    if (c == '\r' || c == '\n') {
+      if (consoleLength == 0) continue;
+      consoleBuffer[consoleLength] = '\0';
+      consoleLength = 0;
+      processConsoleCommand(consoleBuffer);
+    } else if (consoleLength < CONSOLE_BUFFER_SIZE - 1) {
+      consoleBuffer[consoleLength++] = c;
+    }
+  }
+}
+
+void processConsoleCommand(const char* cmd) {
+  if (strcmp(cmd, "STATS") == 0) {
+    dumpTrafficStats();
+  } else if (strcmp(cmd, "STATS RESET") == 0) {
+    resetTrafficStats();
+    Serial.println("[STATS] Sifirlandi.");
+  } else if (strcmp(cmd, "PREDICT ON") == 0 || strcmp(cmd, "PREDICT OFF") == 0) {
+    prediction_enabled = (strcmp(cmd, "PREDICT ON") == 0);
+    Serial.printf("[PREDICT] %s\n", prediction_enabled ? "Acik" : "Kapali");
+  } else if (strcmp(cmd, "PROTO PACKED") == 0 || strcmp(cmd, "PROTO TEXT") == 0) {
+    for (int k = 0; k < MARKER_POOL_SIZE; k++) releaseMarker(k); // Eski kodlamayla gizle
+    if (strcmp(cmd, "PROTO PACKED") == 0) displayOptions |= DISPLAY_OPT_PACKED;
+    else displayOptions &= ~DISPLAY_OPT_PACKED;
+    applyDisplayProtocol();
+    saveSettingsToEEPROM();
+    Serial.printf("[NEXTION] Protokol: %s\n", (displayOptions & DISPLAY_OPT_PACKED) ? "Paketli" : "Metin");
+  } else if (strcmp(cmd, "FLOW ON") == 0 || strcmp(cmd, "FLOW OFF") == 0) {
+    if (strcmp(cmd, "FLOW ON") == 0) displayOptions |= DISPLAY_OPT_FLOW;
+    else displayOptions &= ~DISPLAY_OPT_FLOW;
+    clearNextionAcks();
+    applyDisplayProtocol();
+    saveSettingsToEEPROM();
+    Serial.printf("[NEXTION] Akis kontrolu: %s\n", (displayOptions & DISPLAY_OPT_FLOW) ? "Acik (bkcmd=3)" : "Kapali");
+  } else if (strcmp(cmd, "PROFILE ON") == 0 || strcmp(cmd, "PROFILE OFF") == 0) {
+    if (strcmp(cmd, "PROFILE ON") == 0) displayOptions |= DISPLAY_OPT_PROFILE;
+    else displayOptions &= ~DISPLAY_OPT_PROFILE;
+    profileUnsent = profileFilled;
+    saveSettingsToEEPROM();
+    Serial.printf("[NEXTION] Mesafe profili: %s\n", (displayOptions & DISPLAY_OPT_PROFILE) ? "Acik (sProfile, addt)" : "Kapali");
+  } else if (strcmp(cmd, "RENDER DRAW") == 0 || strcmp(cmd, "RENDER COMPONENTS") == 0 ||
+             strcmp(cmd, "RENDER TFT") == 0) {
+    if (strcmp(cmd, "RENDER TFT") == 0 && !pixelSink) {
+      Serial.println("[NEXTION] TFT destegi yok (-DDISPLAY_TFT=1 ile derleyin)");
+    } else {
+      bool wasDrawing = displayOptions & DISPLAY_OPT_DRAW;
+      displayOptions &= ~DISPLAY_OPT_PRIMS;
+      if (strcmp(cmd, "RENDER DRAW") == 0) displayOptions |= DISPLAY_OPT_DRAW;
+      if (strcmp(cmd, "RENDER TFT") == 0)  displayOptions |= DISPLAY_OPT_TFT;
+      if (wasDrawing && !(displayOptions & DISPLAY_OPT_DRAW)) {
+        sendCommand("ref 0");  // Nextion'daki çizimleri sayfa arka planıyla örter
+        if (!(displayOptions & DISPLAY_OPT_PRIMS)) sendCommand("vis rVehicle,1");
       }
+      invalidateDisplayCache();
+      saveSettingsToEEPROM();
+      const char* const RENDERER_NAME[RENDERER_COUNT] = { "Bilesenler", "Anlik (fill/line/cir)", "Piksel (SPI TFT, DMA)" };
+      Serial.printf("[NEXTION] Cizim: %s\n", RENDERER_NAME[sceneRenderer()]);
     }
-    
-    // --- SAVE3 (Sistem/Ses) ---
-    else if ((cmdPtr = strstr(rxBuffer, "SAVE3:")) != NULL) {
-      char* ptr = cmdPtr + 6;
-      char* vZoom = strtok(ptr, ",");
-      char* vAudio = strtok(NULL, ",");
-
-      if (vZoom && vAudio) {
-        autoZoom_enabled = (atoi(vZoom) == 1);
-        bool newAudioState = (atoi(vAudio) == 1);
-        
-        NEXTION_PRINTF("[SAVE3] Zoom:%d, Ses:%d\n", autoZoom_enabled, newAudioState);
-
-        // MASTER SWITCH: Ses kapatıldıysa Buzzer'ı ANINDA sustur
-        if (!newAudioState) {
-            digitalWrite(BUZZER_PIN, LOW);
-            buzzerIsOn = false;
-            buzzerShouldBeActive = false;
-        }
-        
-        audioAlarm_enabled = newAudioState;
-        saveSettingsToEEPROM();
+  } else if (strcmp(cmd, "ANIM ON") == 0 || strcmp(cmd, "ANIM OFF") == 0) {
+    if (strcmp(cmd, "ANIM ON") == 0) displayOptions |= DISPLAY_OPT_MOVE;
+    else displayOptions &= ~DISPLAY_OPT_MOVE;
+    saveSettingsToEEPROM();
+    Serial.printf("[NEXTION] Marker animasyonu: %s%s\n", (displayOptions & DISPLAY_OPT_MOVE) ? "move" : "x/y",
+                  (displayOptions & DISPLAY_OPT_PACKED) ? " (paketli protokolde kullanilmaz)" : "");
+  } else if (strcmp(cmd, "RATE AUTO") == 0 || strcmp(cmd, "RATE OFF") == 0) {
+    renderRate_auto = (strcmp(cmd, "RATE AUTO") == 0);
+    if (!renderRate_auto) renderLod = LOD_TEXT;
+    Serial.printf("[RENDER] Cizim hizi: %s\n", renderRate_auto ? "Otomatik" : "Her tarama, tam ayrinti");
+  } else if (strcmp(cmd, "PRIO ON") == 0 || strcmp(cmd, "PRIO OFF") == 0) {
+    nexPriority_enabled = (strcmp(cmd, "PRIO ON") == 0);
+    Serial.printf("[NEXTION] Oncelikli kuyruk: %s\n", nexPriority_enabled ? "Acik" : "Kapali (sirali)");
+  } else if (strcmp(cmd, "REFBATCH ON") == 0 || strcmp(cmd, "REFBATCH OFF") == 0) {
+    refBatch_enabled = (strcmp(cmd, "REFBATCH ON") == 0);
+    Serial.printf("[NEXTION] ref_stop/ref_star: %s\n", refBatch_enabled ? "Acik" : "Kapali");
+  } else if (strcmp(cmd, "TARGETS") == 0) {
+    dumpTargets();
+  } else if (strcmp(cmd, "BENCH") == 0) {
+    runKernelBenchmark();
+    runFieldBenchmark();
+  } else if (strcmp(cmd, "FIELDS NUMERIC") == 0 || strcmp(cmd, "FIELDS TEXT") == 0) {
+    bool numeric = (strcmp(cmd, "FIELDS NUMERIC") == 0);
+    if (numeric) {
+      for (int f = 0; f < FIELD_COUNT; f++) sendCommand(String(FIELD_TEXT[f]) + ".txt=\"\"");
+      displayOptions |= DISPLAY_OPT_NUMERIC;
+    } else {
+      clearFieldDisplays();
+      displayOptions &= ~DISPLAY_OPT_NUMERIC;
+    }
+    numericShown = false;
+    if (!targetVisible) clearFieldDisplays();
+    saveSettingsToEEPROM();
+    Serial.printf("[NEXTION] Hedef alanlari: %s\n", numeric ? "Sayisal" : "Metin");
+  } else if (strncmp(cmd, "STEER ID ", 9) == 0) {
+    long value = strtol(cmd + 9, NULL, 16);
+    if (value >= 0 && value <= 0x7FF && (value < (long)RADAR_ID_FIRST || value > (long)RADAR_ID_LAST) &&
+        (value == 0 || value != speedCanId)) {
+      steerCanId = (uint16_t)value;
+      updatePathModel();
+      saveSettingsToEEPROM();
+      Serial.printf("[STEER] CAN ID: 0x%03X%s\n", steerCanId, steerCanId ? "" : " (kapali)");
+    } else {
+      Serial.println("[STEER] Gecersiz ID (0 = kapali, radar araligi disinda 11 bit)");
+    }
+  } else if (strncmp(cmd, "SPEED ID ", 9) == 0) {
+    long value = strtol(cmd + 9, NULL, 16);
+    if (value >= 0 && value <= 0x7FF && (value < (long)RADAR_ID_FIRST || value > (long)RADAR_ID_LAST) &&
+        (value == 0 || value != steerCanId)) {
+      speedCanId = (uint16_t)value;
+      updatePathModel();
+      saveSettingsToEEPROM();
+      Serial.printf("[SPEED] CAN ID: 0x%03X%s\n", speedCanId, speedCanId ? "" : " (kapali)");
+    } else {
+      Serial.println("[SPEED] Gecersiz ID (0 = kapali, radar/direksiyon disinda 11 bit)");
+    }
+  } else if (strcmp(cmd, "SPEED YAW ON") == 0 || strcmp(cmd, "SPEED YAW OFF") == 0) {
+    if (strcmp(cmd, "SPEED YAW ON") == 0) speedOptions |= SPEED_OPT_YAW;
+    else { speedOptions &= ~SPEED_OPT_YAW; egoYaw_mrads = 0; }
+    updatePathModel();
+    saveSettingsToEEPROM();
+    Serial.printf("[SPEED] Yaw rate: %s\n", (speedOptions & SPEED_OPT_YAW) ? "Acik" : "Kapali");
+  } else if (strcmp(cmd, "CLUTTER LEARN") == 0 || strncmp(cmd, "CLUTTER LEARN ", 14) == 0) {
+    int seconds = cmd[13] ? atoi(cmd + 14) : CLUTTER_LEARN_DEFAULT_S;
+    if (seconds >= CLUTTER_LEARN_MIN_S && seconds <= CLUTTER_LEARN_MAX_S) startClutterLearning(seconds);
+    else Serial.printf("[CLUTTER] Gecersiz sure (%d-%d s)\n", CLUTTER_LEARN_MIN_S, CLUTTER_LEARN_MAX_S);
+  } else if (strcmp(cmd, "CLUTTER ON") == 0 || strcmp(cmd, "CLUTTER OFF") == 0) {
+    if (strcmp(cmd, "CLUTTER ON") == 0) clutterOptions |= CLUTTER_OPT_ENABLE;
+    else clutterOptions &= ~CLUTTER_OPT_ENABLE;
+    saveSettingsToEEPROM();
+    Serial.printf("[CLUTTER] Maske: %s, %d hucre\n", (clutterOptions & CLUTTER_OPT_ENABLE) ? "Acik" : "Kapali", countClutterCells());
+  } else if (strncmp(cmd, "MARKERS ", 8) == 0) {
+    int n = atoi(cmd + 8);
+    if (n >= 1 && n <= MARKER_POOL_SIZE) {
+      for (int k = n; k < markerPoolSize; k++) releaseMarker(k);
+      markerPoolSize = n;
+      saveSettingsToEEPROM();
+      Serial.printf("[NEXTION] Marker havuzu: %d\n", markerPoolSize);
+    } else {
+      Serial.printf("[NEXTION] Gecersiz havuz boyutu (1-%d)\n", MARKER_POOL_SIZE);
+    }
+  } else if (strcmp(cmd, "REFRESH LIST") == 0) {
+    Serial.printf("[REFRESH] Butce: %u B/s\n", elementBudget_Bps);
+    for (int el = 0; el < ELEMENT_COUNT; el++) {
+      Serial.printf("  %-6s %s\n", ELEMENT_NAME[el], REFRESH_NAME[refreshClass[el]]);
+    }
+  } else if (strncmp(cmd, "REFRESH ", 8) == 0) {
+    char name[8], cls[8];
+    int el = -1, c = -1;
+    if (sscanf(cmd + 8, "%7s %7s", name, cls) == 2) {
+      for (int i = 0; i < ELEMENT_COUNT; i++) if (strcmp(name, ELEMENT_NAME[i]) == 0) el = i;
+      for (int i = 0; i < 4; i++) if (strcmp(cls, REFRESH_NAME[i]) == 0) c = i;
+    }
+    if (el >= 0 && c >= 0) {
+      refreshClass[el] = c;
+      saveSettingsToEEPROM();
+      Serial.printf("[REFRESH] %s: %s\n", ELEMENT_NAME[el], REFRESH_NAME[c]);
+    } else {
+      Serial.println("[REFRESH] Kullanim: REFRESH <MESAFE|ACI|X|Y|DURUM|ARAC> <FRAME|4HZ|1HZ|CHANGE>");
+    }
+  } else if (strncmp(cmd, "BUDGET ", 7) == 0) {
+    int bps = atoi(cmd + 7);
+    if (bps >= ELEMENT_BUDGET_MIN_BPS && bps <= ELEMENT_BUDGET_MAX_BPS) {
+      elementBudget_Bps = bps;
+      saveSettingsToEEPROM();
+      Serial.printf("[REFRESH] Butce: %u B/s\n", elementBudget_Bps);
+    } else {
+      Serial.printf("[REFRESH] Gecersiz butce (%u-%u B/s)\n", ELEMENT_BUDGET_MIN_BPS, ELEMENT_BUDGET_MAX_BPS);
+    }
+  } else if (strcmp(cmd, "OCC MAP") == 0) {
+    dumpOccupancyMap();
+  } else if (strcmp(cmd, "OCC OVERLAY ON") == 0 || strcmp(cmd, "OCC OVERLAY OFF") == 0) {
+    if (strcmp(cmd, "OCC OVERLAY ON") == 0) occOptions |= OCC_OPT_OVERLAY;
+    else occOptions &= ~OCC_OPT_OVERLAY;
+    saveSettingsToEEPROM();
+    Serial.printf("[OCC] Yakin engel katmani: %s\n", (occOptions & OCC_OPT_OVERLAY) ? "Acik" : "Kapali");
+  } else if (strcmp(cmd, "OCC CONFIRM ON") == 0 || strcmp(cmd, "OCC CONFIRM OFF") == 0) {
+    if (strcmp(cmd, "OCC CONFIRM ON") == 0) occOptions |= OCC_OPT_CONFIRM;
+    else occOptions &= ~OCC_OPT_CONFIRM;
+    saveSettingsToEEPROM();
+    Serial.printf("[OCC] Doluluk onayi: %s\n", (occOptions & OCC_OPT_CONFIRM) ? "Acik" : "Kapali");
+  } else if (strcmp(cmd, "CLUTTER CLEAR") == 0) {
+    clutterLearning = false;
+    memset(clutterMask, 0, sizeof(clutterMask));
+    saveSettingsToEEPROM();
+    Serial.println("[CLUTTER] Maske silindi.");
+  } else if (strcmp(cmd, "ZONE LIST") == 0) {
+    dumpPolyZones();
+  } else if (strcmp(cmd, "ZONE CLEAR") == 0) {
+    memset(polyZones, 0, sizeof(polyZones));
+    rebuildZoneGrid();
+    saveSettingsToEEPROM();
+    Serial.println("[ZONE] Tum bolgeler silindi.");
+  } else if (strncmp(cmd, "ZONE NEW ", 9) == 0) {
+    int level = atoi(cmd + 9);
+    int z = 0;
+    while (z < POLY_ZONE_MAX && (polyZones[z].count > 0 || polyZones[z].level != ZONE_SAFE)) z++;
+    if (level < ZONE_WARNING || level > ZONE_ALARM) {
+      Serial.println("[ZONE] Gecersiz seviye (1 = sari, 2 = turuncu, 3 = kirmizi)");
+    } else if (z == POLY_ZONE_MAX) {
+      Serial.println("[ZONE] Bos bolge yok.");
+    } else {
+      polyZones[z].level = level;
+      polyZones[z].count = 0;
+      saveSettingsToEEPROM();
+      Serial.printf("[ZONE] Bolge %d olusturuldu, seviye %d\n", z, level);
+    }
+  } else if (strncmp(cmd, "ZONE ADD ", 9) == 0) {
+    int z, x, y;
+    if (sscanf(cmd + 9, "%d %d,%d", &z, &x, &y) == 3 && z >= 0 && z < POLY_ZONE_MAX &&
+        polyZones[z].level != ZONE_SAFE && polyZones[z].count < POLY_VERTEX_MAX) {
+      PolyZone& pz = polyZones[z];
+      pz.x_cm[pz.count] = constrain(x, -32000, 32000);
+      pz.y_cm[pz.count] = constrain(y, -32000, 32000);
+      pz.count++;
+      rebuildZoneGrid();
+      saveSettingsToEEPROM();
+      Serial.printf("[ZONE] Bolge %d: %d kose\n", z, pz.count);
+    } else {
+      Serial.println("[ZONE] Kullanim: ZONE ADD <bolge> <x_cm>,<y_cm> (en fazla 8 kose)");
+    }
+  } else if (strncmp(cmd, "ZONE DEL ", 9) == 0) {
+    int z = atoi(cmd + 9);
+    if (z >= 0 && z < POLY_ZONE_MAX) {
+      memset(&polyZones[z], 0, sizeof(PolyZone));
+      rebuildZoneGrid();
+      saveSettingsToEEPROM();
+      Serial.printf("[ZONE] Bolge %d silindi.\n", z);
+    }
+  } else if (strncmp(cmd, "STEER WB ", 9) == 0) {
+    long value = atol(cmd + 9);
+    if (value >= WHEELBASE_MIN_CM && value <= WHEELBASE_MAX_CM) {
+      wheelbase_cm = (uint16_t)value;
+      updatePathModel();
+      saveSettingsToEEPROM();
+      Serial.printf("[STEER] Aks mesafesi: %u cm\n", wheelbase_cm);
+    } else {
+      Serial.printf("[STEER] Gecersiz deger (%u-%u cm)\n", WHEELBASE_MIN_CM, WHEELBASE_MAX_CM);
+    }
+  } else if (strncmp(cmd, "SENSOR TIMEOUT ", 15) == 0) {
+    long value = atol(cmd + 15);
+    if (value >= SENSOR_TIMEOUT_MIN_MS && value <= SENSOR_TIMEOUT_MAX_MS) {
+      sensorTimeout_ms = (uint16_t)value;
+      saveSettingsToEEPROM();
+      Serial.printf("[SENSOR] Zaman asimi: %u ms\n", sensorTimeout_ms);
+    } else {
+      Serial.printf("[SENSOR] Gecersiz deger (%u-%u ms)\n", SENSOR_TIMEOUT_MIN_MS, SENSOR_TIMEOUT_MAX_MS);
+    }
+  } else if (strncmp(cmd, "SENSOR MASK ", 12) == 0) {
+    long value = strtol(cmd + 12, NULL, 16);
+    if (value > 0 && value <= 0xFF) {
+      sensorExpectedMask = (uint8_t)value;
+      sensorFaultMask &= sensorExpectedMask;
+      saveSettingsToEEPROM();
+      Serial.printf("[SENSOR] Beklenen maske: 0x%02X\n", sensorExpectedMask);
+    } else {
+      Serial.println("[SENSOR] Gecersiz maske (01-FF)");
+    }
+  } else {
+    Serial.printf("[KONSOL] Bilinmeyen komut: %s\n", cmd);
+  }
+}
+
+// -------------------------------------------------------------------------------------------------
+// TRAFİK İSTATİSTİKLERİ
+// -------------------------------------------------------------------------------------------------
+// Çerçeve başına O(1): sadece ilgili slotun sayaçları ve kayan ortalamaları güncellenir.
+void updateSlotStats(int slot, bool valid, unsigned long now) {
+  SlotStats& s = slotStats[slot];
+
+  if (s.frames > 0) {
+    uint32_t interval_ms = now - s.lastSeen_ms;
+    if (interval_ms > 4095) interval_ms = 4095; // Q4 uint16 sınırı
+    int32_t sample_q4 = (int32_t)(interval_ms << 4);
+
+    if (s.frames == 1) {
+      s.meanInterval_q4 = sample_q4;
+    } else {
+      int32_t delta = sample_q4 - s.meanInterval_q4;
+      s.meanInterval_q4 += delta / 8;
+      s.jitter_q4 += ((delta < 0 ? -delta : delta) - (int32_t)s.jitter_q4) / 16;
+    }
+  }
+
+  s.frames++;
+  if (!valid) s.invalidFrames++;
+  s.lastSeen_ms = now;
+}
+
+void resetTrafficStats() {
+  memset(slotStats, 0, sizeof(slotStats));
+  memset(&predStats, 0, sizeof(predStats));
+  memset(&renderStats, 0, sizeof(renderStats));
+  memset(&pageStats, 0, sizeof(pageStats));
+  memset(&flowStats, 0, sizeof(flowStats));
+  memset(&linkStats, 0, sizeof(linkStats));
+  memset(&queueStats, 0, sizeof(queueStats));
+  rateCtl.deferred = rateCtl.lodDowns = rateCtl.lodUps = 0;
+  memset(&elementStats, 0, sizeof(elementStats));
+  memset(&profileStats, 0, sizeof(profileStats));
+  memset(&rasterStats, 0, sizeof(rasterStats));
+  canFramesOther = 0;
+  clutterRejected = 0;
+  statsResetTime = millis();
+}
+
+void dumpTrafficStats() {
+  unsigned long now = millis();
+  unsigned long elapsed_ms = now - statsResetTime;
+
+  Serial.printf("\n[STATS] Sure: %lu ms, Diger CAN: %u\n", elapsed_ms, canFramesOther);
+  Serial.printf("Nextion sayfa: %u, %u degisim, %u bastirilan cizim, %u alarm donusu\n",
+                nextionPage, pageStats.changes, pageStats.suppressed, pageStats.alarmReturns);
+  const char* const LOD_NAME[3] = { "konum", "konum+renk", "konum+renk+metin" };
+  Serial.printf("Cizim hizi (%s): aralik %u ms, ayrinti %s, kare ort %u bayt, hat %u B/s (%%%u), %u ertelenen tarama, ayrinti %u dusus / %u artis\n",
+                renderRate_auto ? "otomatik" : "her tarama", renderRate_auto ? renderInterval_ms : 0, LOD_NAME[renderLod],
+                rateCtl.frameBytesAvg, rateCtl.wireBps, (uint32_t)(rateCtl.wireBps * 100 / (NEXTION_BAUD / 10)), rateCtl.deferred,
+                rateCtl.lodDowns, rateCtl.lodUps);
+  uint32_t elapsed_s = (now - statsResetTime) / 1000;
+  uint32_t elementBytes = 0;
+  Serial.printf("Ogeler (butce %u B/s):", elementBudget_Bps);
+  for (int el = 0; el < ELEMENT_COUNT; el++) {
+    Serial.printf(" %s/%s %u", ELEMENT_NAME[el], REFRESH_NAME[refreshClass[el]], elementStats.sent[el]);
+    elementBytes += elementStats.bytes[el];
+  }
+  Serial.printf(", ort %u B/s, %u butce atlamasi\n", elapsed_s ? elementBytes / elapsed_s : 0, elementStats.budgetSkips);
+  Serial.printf("Cikis kuyrugu (%s): alarm %u komut, gecikme ort %u / maks %u ms (sirali olsaydi maks %u ms), %u yerine gecen (%u bayt), derinlik maks %u, %u zorla, %u sirasi bozulan kare komutu\n",
+                nexPriority_enabled ? "oncelikli" : "sirali", queueStats.alarmCmds,
+                queueStats.alarmCmds ? queueStats.alarmLatSum_ms / queueStats.alarmCmds : 0, queueStats.alarmLatMax_ms,
+                queueStats.alarmFifoMax_ms, queueStats.superseded, queueStats.supersededBytes, queueStats.depthMax,
+                queueStats.forced, queueStats.frameReorders);
+  Serial.printf("Nextion hat: %s, %u acilis, %u hazir, %u zaman asimi, %u tam senkron (maks %u ms), %u yinelenen tetik\n",
+                nextionLinkUp ? "acik" : "KOPUK", linkStats.startups, linkStats.readies, linkStats.timeouts,
+                linkStats.resyncs, linkStats.resyncMax_ms, linkStats.ignored);
+  if (displayOptions & DISPLAY_OPT_PROFILE) {
+    Serial.printf("Mesafe profili: %u aktarim, %u nokta, %u bayt (add ile %u bayt), kuyruk bekleme maks %u ms, %u cevapsiz, %u alarmda ertelenen, %u aktarimda dusen komut\n",
+                  profileStats.bursts, profileStats.points, profileStats.bytes, profileStats.addBytes,
+                  profileStats.maxHold_ms, profileStats.timeouts, profileStats.deferred, profileStats.dropped);
+  }
+  if (displayOptions & DISPLAY_OPT_FLOW) {
+    Serial.printf("Akis kontrolu: %u cevap, RTT ort %u / maks %u ms, bekleyen %u (maks %u / kredi %d), %u zaman asimi, %u atlanan kare, %u kuyrukta bekleme, %u dusen, %u birlesen kayit\n",
+                  flowStats.acks, flowStats.acks ? flowStats.rttSum_ms / flowStats.acks : 0, flowStats.rttMax_ms,
+                  nexAckCount, flowStats.outstandingMax, NEX_CREDIT_LIMIT, flowStats.timeouts, flowStats.paused,
+                  flowStats.held, flowStats.dropped, flowStats.merged);
+  }
+  for (int kind = 0; kind <= NEX_ERROR_KINDS; kind++) {
+    if (flowStats.errors[kind] == 0) continue;
+    if (kind < NEX_ERROR_KINDS) Serial.printf("Nextion hata 0x%02X (%s): %u\n", NEX_ERRORS[kind].code, NEX_ERRORS[kind].name, flowStats.errors[kind]);
+    else                        Serial.printf("Nextion hata (diger): %u\n", flowStats.errors[kind]);
+  }
+  Serial.printf("Sensor maske: 0x%02X, hata: 0x%02X, zaman asimi: %u ms\n",
+                sensorExpectedMask, sensorFaultMask, sensorTimeout_ms);
+  Serial.printf("Karmasa maskesi: %s, %d hucre, %u cerceve elendi\n",
+                (clutterOptions & CLUTTER_OPT_ENABLE) ? "acik" : "kapali", countClutterCells(), clutterRejected);
+  if (steerCanId != 0) {
+    Serial.printf("Direksiyon 0x%03X: %d.%d derece, %s, yaricap %ld cm\n",
+                  steerCanId, steeringAngle_ddeg / 10, abs(steeringAngle_ddeg % 10),
+                  (now - steeringSeen_ms) <= STEER_TIMEOUT_MS ? "guncel" : "bayat",
+                  pathModel.curved ? (long)pathModel.centerY_cm : 0L);
+  }
+  if (speedCanId != 0) {
+    Serial.printf("Hiz 0x%03X: %d cm/s, yaw %d mrad/s, %s, bolge payi %d cm\n",
+                  speedCanId, egoSpeed_cms, egoYaw_mrads,
+                  (now - speedSeen_ms) <= SPEED_TIMEOUT_MS ? "guncel" : "bayat", zoneSpeedMargin_cm);
+  }
+  if (predStats.samples > 0) {
+    Serial.printf("Tahmin (%s): %u cizim, ufuk ort %u ms / maks %u ms, %u ornek hata ort %u cm (tahminsiz %u cm)\n",
+                  prediction_enabled ? "acik" : "kapali", predStats.renders,
+                  predStats.horizonSum_ms / predStats.renders, predStats.horizonMax_ms, predStats.samples,
+                  predStats.errPredictedSum_cm / predStats.samples, predStats.errHeldSum_cm / predStats.samples);
+  }
+
+  if (renderStats.frames > 0) {
+    Serial.printf("Cizim: %u kare, ort %u / maks %u bayt (butce %d), ort %u.%02u marker (havuz %u), butce disi %u hedef\n",
+                  renderStats.frames, renderStats.bytesSum / renderStats.frames, renderStats.bytesMax, FRAME_BYTE_BUDGET,
+                  renderStats.markersSum / renderStats.frames, renderStats.markersSum * 100 / renderStats.frames % 100,
+                  markerPoolSize, renderStats.budgetDropped);
+    Serial.printf("Kare gecikmesi (%s): ort %u / maks %u ms, TX kuyrugu maks %u bayt\n",
+                  refBatch_enabled ? "ref_stop/ref_star" : "dogrudan", renderStats.latencySum_ms / renderStats.frames,
+                  renderStats.latencyMax_ms, renderStats.backlogMax);
+    if (renderStats.fieldCalls > 0) {
+      Serial.printf("Hedef alanlari (%s): ort %u bayt, %u cevrim\n",
+                    (displayOptions & DISPLAY_OPT_NUMERIC) ? "sayisal" : "metin",
+                    renderStats.fieldBytesSum / renderStats.fieldCalls, renderStats.fieldCyclesSum / renderStats.fieldCalls);
+    }
+    Serial.printf("Sahne+marker (%s): metin %u bayt (%u/kare), paketli %u bayt (%u/kare)\n",
+                  (displayOptions & DISPLAY_OPT_PACKED) ? "paketli" : "metin",
+                  renderStats.sceneTextBytes, renderStats.sceneTextBytes / renderStats.frames,
+                  renderStats.scenePackedBytes, renderStats.scenePackedBytes / renderStats.frames);
+    const char* const RENDERER_STAT_NAME[RENDERER_COUNT] = { "bilesen", "anlik cizim", "SPI TFT" };
+    for (int r = 0; r < RENDERER_COUNT; r++) {
+      if (renderStats.cmdFrames[r] == 0) continue;
+      Serial.printf("Komut/kare (%s): %u.%02u, %u kare", RENDERER_STAT_NAME[r],
+                    renderStats.cmdsSum[r] / renderStats.cmdFrames[r], renderStats.cmdsSum[r] * 100 / renderStats.cmdFrames[r] % 100,
+                    renderStats.cmdFrames[r]);
+      if (r == RENDERER_DRAW) {
+        Serial.printf(", silinen %u piksel/kare, %u tam cizim", renderStats.drawPixels / renderStats.cmdFrames[r],
+                      renderStats.drawFullRedraws);
+      }
+      if (r == RENDERER_TFT) {
+        Serial.printf(", gonderilen %u piksel/kare, %u bolge, hazirlama maks %u us, %u DMA beklemesi",
+                      rasterStats.pixels / renderStats.cmdFrames[r], rasterStats.regions, rasterStats.flushMax_us,
+                      rasterStats.dmaWaits);
       }
+      Serial.println();
     }
-    
-    // --- RESET ---
-    else if (strstr(rxBuffer, "RESETALL") != NULL) {
-      resetToDefaults();
-      NEXTION_PRINTF("[RESET] Fabrika ayarlari.\n");
+    uint32_t elapsed_s = (now - statsResetTime) / 1000;
+    if (elapsed_s > 0 && renderStats.markerXYBytes > 0) {
+      Serial.printf("Marker hareketi (%s, %u ms): x/y %u B/s, move %u B/s, ayni akicilikta x/y (20 Hz) %u B/s\n",
+                    moveDuration_ms() ? "move" : "x/y", renderCycle_ms, renderStats.markerXYBytes / elapsed_s,
+                    renderStats.markerMoveBytes / elapsed_s, renderStats.markerSmoothBytes / elapsed_s);
+    }
+  }
+
+  for (int sensor = 0; sensor < RADAR_SENSOR_COUNT; sensor++) {
+    uint32_t sensorFrames = 0, sensorInvalid = 0;
+    int activeSlots = 0;
+    for (int obj = 0; obj < RADAR_OBJECTS_PER_SENSOR; obj++) {
+      const SlotStats& s = slotStats[sensor * RADAR_OBJECTS_PER_SENSOR + obj];
+      sensorFrames += s.frames;
+      sensorInvalid += s.invalidFrames;
+      if (s.frames > 0) activeSlots++;
+    }
+    if (sensorFrames == 0) continue;
+
+    Serial.printf("Sensor %d: %u cerceve, %u gecersiz (%u%%), %d aktif slot, %lu Hz\n",
+                  sensor, sensorFrames, sensorInvalid, sensorInvalid * 100 / sensorFrames,
+                  activeSlots, elapsed_ms > 0 ? (unsigned long)sensorFrames * 1000 / elapsed_ms : 0);
+
+    for (int obj = 0; obj < RADAR_OBJECTS_PER_SENSOR; obj++) {
+      int slot = sensor * RADAR_OBJECTS_PER_SENSOR + obj;
+      const SlotStats& s = slotStats[slot];
+      if (s.frames == 0) continue;
+      Serial.printf("  0x%03X: %u cerceve, gecersiz %u%%, aralik %u.%u ms, jitter %u.%u ms, son %lu ms once\n",
+                    RADAR_ID_FIRST + slot, s.frames, s.invalidFrames * 100 / s.frames,
+                    s.meanInterval_q4 >> 4, ((s.meanInterval_q4 & 0x0F) * 10) >> 4,
+                    s.jitter_q4 >> 4, ((s.jitter_q4 & 0x0F) * 10) >> 4,
+                    now - s.lastSeen_ms);
     }
   }
 }
 
+// -------------------------------------------------------------------------------------------------
+// SENSÖR DENETİMİ
+// -------------------------------------------------------------------------------------------------
+// Çerçeve yolu: tek yazma + tek bit testi. Hata durumundaki sensör ilk çerçevede geri alınır.
+void markSensorAlive(int sensor, unsigned long now) {
+  sensorLastSeen_ms[sensor] = now;
+
+  uint8_t bit = 1 << sensor;
+  if (sensorFaultMask & bit) {
+    sensorFaultMask &= ~bit;
+    Serial.printf("[SENSOR] Sensor %d geri geldi.\n", sensor);
+    if (sensorFaultMask == 0) statusPending = true;
+  }
+}
+
+void superviseSensors() {
+  unsigned long now = millis();
+  if (now - lastSupervisionTime < SENSOR_SUPERVISION_PERIOD_MS) return;
+  lastSupervisionTime = now;
+
+  uint8_t newFaults = 0;
+  for (int sensor = 0; sensor < RADAR_SENSOR_COUNT; sensor++) {
+    uint8_t bit = 1 << sensor;
+    if (!(sensorExpectedMask & bit) || (sensorFaultMask & bit)) continue;
+    if (now - sensorLastSeen_ms[sensor] > sensorTimeout_ms) newFaults |= bit;
+  }
+  if (newFaults == 0) return;
+
+  bool wasHealthy = (sensorFaultMask == 0);
+  sensorFaultMask |= newFaults;
+  Serial.printf("[SENSOR] Zaman asimi! Hata maskesi: 0x%02X\n", sensorFaultMask);
+  if (wasHealthy) statusPending = true;
+}
+
+// Durum metni: hedef varken "HEDEF", yokken sensör hatası "Temiz" ile karışmasın.
+int32_t statusCode() {
+  if (targetVisible)   return STATUS_TARGET;
+  if (sensorFaultMask) return STATUS_FAULT;
+  return STATUS_CLEAR;
+}
+
+// Sadece kare içinden çağrılır: her durum yazımı kare önceliğiyle, diğer öğeler gibi sınıf ve bütçeden geçer.
+void updateStatusText() {
+  int32_t status = statusCode();
+  statusPending = elementValue[EL_STATUS] != status;  // Bütçeye sığmazsa sonraki karede yeniden denenir
+  if (!statusPending || !elementDue(EL_STATUS, status)) return;
+  String cmd = "tDurum.txt=\"" + String(STATUS_TEXT[status]) + "\"";
+  if (!spendElement(EL_STATUS, status, cmd.length() + 3)) return;
+  sendCommand(cmd);
+  statusPending = false;
+}
+
 // -------------------------------------------------------------------------------------------------
 // RADAR GÖRSELLEŞTİRME MOTORU
 // -------------------------------------------------------------------------------------------------
-void handleDetection(const twai_message_t& msg) {
+void handleDetection(int i) {
   RADAR_PRINTLN("\n--- HEDEF SAPTANDI ---");
   
-  // 1. Ham Veriyi Çevirme
-  float polarRadius_m = msg.data[0] * 0.25;
-  int   polarAngle_deg = (int)msg.data[1] - 128;
-  float doc_x_m = msg.data[2] * 0.25;             // İleri (Simülasyon Y)
-  float doc_y_m = ((int)msg.data[3] - 128) * 0.25;// Yanal (Simülasyon X)
+  // 1. Depodaki (decode edilmiş) hedef, cm
+  int polarRadius_cm  = targets.r_cm[i];
+  int polarAngle_deg  = targets.angle_deg[i];
+  int doc_x_cm        = targets.x_cm[i];  // İleri (Simülasyon Y)
+  int doc_y_cm        = targets.y_cm[i];  // Yanal (Simülasyon X)
   
-  RADAR_PRINTF("  Mesafe:%.2fm, X:%.2fm, Y:%.2fm\n", polarRadius_m, doc_x_m, doc_y_m);
-
-  // 2. Grid Genişliği Belirleme (AutoZoom)
-  float currentMaxGridXMeters; 
-  int backgroundPicId, targetColor;
-
-  if (autoZoom_enabled) {
-      if (polarRadius_m > 5.0) { 
-          currentMaxGridXMeters = 10.0; backgroundPicId = PIC_ID_SAFE; targetColor = COLOR_GREEN; 
-      } else if (polarRadius_m > 3.0) { 
-          currentMaxGridXMeters = 8.0; backgroundPicId = PIC_ID_WARNING; targetColor = COLOR_YELLOW; 
-      } else if (polarRadius_m > 1.5) { 
-          currentMaxGridXMeters = 6.0; backgroundPicId = PIC_ID_DANGER; targetColor = COLOR_ORANGE; 
-      } else { 
-          currentMaxGridXMeters = 4.0; backgroundPicId = PIC_ID_ALARM; targetColor = COLOR_RED; 
-      }
-  } else {
-      currentMaxGridXMeters = 10.0;
-      if (polarRadius_m > warningZone_m) { backgroundPicId = PIC_ID_SAFE; targetColor = COLOR_GREEN; }
-      else if (polarRadius_m > dangerZone_m) { backgroundPicId = PIC_ID_WARNING; targetColor = COLOR_YELLOW; }
-      else { backgroundPicId = PIC_ID_ALARM; targetColor = COLOR_RED; }
-  }
-
-  // 3. Eşit Ölçekleme (Fixed Scale)
-  float fixedScale = (float)SCREEN_WIDTH_PX / currentMaxGridXMeters;
-
-  // 4. Koordinat Hesaplama
-  // X Ekseni (Yanal)
-  float targetX_float = (doc_y_m + (currentMaxGridXMeters / 2.0)) * fixedScale;
-  int targetX_px = (int)(targetX_float + 0.5);
-
-  // Y Ekseni (İleri)
-  float targetY_float = (float)SCREEN_HEIGHT_PX - (doc_x_m * fixedScale);
-  int targetY_px = (int)(targetY_float + 0.5);
-
-  // Sınırlandırma
-  targetX_px = constrain(targetX_px, 0, SCREEN_WIDTH_PX - TARGET_OBJECT_SIZE_PX);
-  targetY_px = constrain(targetY_px, 0, SCREEN_HEIGHT_PX - TARGET_OBJECT_SIZE_PX);
-
-  // 5. Buzzer Mantığı
-  if (audioAlarm_enabled && (polarRadius_m < warningZone_m) && (abs(doc_y_m) < (vehicleRealWidth_m / 2.0 + sideMargin_m))) {
-    buzzerShouldBeActive = true;
-    if (polarRadius_m <= SOLID_TONE_DISTANCE_M) currentBeepInterval = 0;
-    else if (backgroundPicId == PIC_ID_ALARM)   currentBeepInterval = BEEP_INTERVAL_RED_MS;
-    else if (backgroundPicId == PIC_ID_DANGER)  currentBeepInterval = BEEP_INTERVAL_ORANGE_MS;
-    else                                        currentBeepInterval = BEEP_INTERVAL_YELLOW_MS;
-  } else {
-    buzzerShouldBeActive = false;
+  RADAR_PRINTF("  Mesafe:%dcm, X:%dcm, Y:%dcm\n", polarRadius_cm, doc_x_cm, doc_y_cm);
+
+  // 2. Grid Genişliği Belirleme (AutoZoom) - bölge classifyZones() ile hesaplandı
+  uint8_t zone = targets.zone[i];
+  int gridWidth_cm    = autoZoom_enabled ? ZONE_GRID_CM[zone] : DEFAULT_GRID_CM;
+  int backgroundPicId = ZONE_PIC_ID[zone];
+
+  // 3. Kare başlangıcı (ref_stop), marker atamaları (sadece değişen atamalar vis gönderir), bayt bütçesi
+  int frameBudget = FRAME_BYTE_BUDGET - nextionTxBacklog();
+  beginFrame();
+  int sel[MARKER_POOL_SIZE];
+  int selCount = assignMarkers(i, sel);
+
+  // 4. Arka plan, yakın engeller ve araç (marker'dan önce kuyruğa girer)
+  renderedTarget = i;
+  renderedZone   = zone;
+  renderDirty    = false;
+  uint32_t sinceRender_ms = millis() - lastRender_ms;
+  if (sinceRender_ms < (uint32_t)MOVE_MAX_MS) renderCycle_ms = (3 * renderCycle_ms + sinceRender_ms) / 4;
+  lastRender_ms  = millis();
+  updateScene(backgroundPicId, gridWidth_cm, targets.cell[i]);
+
+  // 5. Tahmin: ölçüm yaşı + UART kuyruğunun boşalma süresi kadar ileri kestir
+  uint32_t horizon_ms = (millis() - targets.seen_ms[i]) + nextionTxLatency_ms();
+  if (horizon_ms > PREDICTION_MAX_MS) horizon_ms = PREDICTION_MAX_MS;
+
+  int marker_x_cm = doc_x_cm, marker_y_cm = doc_y_cm;
+  if (prediction_enabled) {
+    marker_x_cm += (int32_t)targets.vx_cms[i] * (int32_t)horizon_ms / 1000;
+    marker_y_cm += (int32_t)targets.vy_cms[i] * (int32_t)horizon_ms / 1000;
+  }
+
+  predSlot   = i;
+  predX0_cm  = doc_x_cm;
+  predY0_cm  = doc_y_cm;
+  predVx_cms = targets.vx_cms[i];
+  predVy_cms = targets.vy_cms[i];
+  predT0_ms  = targets.seen_ms[i];
+  predStats.renders++;
+  predStats.horizonSum_ms += horizon_ms;
+  if (horizon_ms > predStats.horizonMax_ms) predStats.horizonMax_ms = horizon_ms;
+
+  // Animasyonda marker bir çizim aralığı sonraki konuma kayar (tahmin kapalıysa ölçülen konuma)
+  uint32_t move_ms = moveDuration_ms();
+  if (move_ms > 0 && prediction_enabled) {
+    marker_x_cm += (int32_t)targets.vx_cms[i] * (int32_t)move_ms / 1000;
+    marker_y_cm += (int32_t)targets.vy_cms[i] * (int32_t)move_ms / 1000;
+  }
+
+  // 6. Eşit Ölçekli (Fixed Scale) koordinat hesabı ve sınırlandırma
+  int targetX_px, targetY_px;
+  mapTargetToPixels(marker_x_cm, marker_y_cm, gridWidth_cm, targetX_px, targetY_px);
+
+  // 7. Güncelleme (Buzzer kararı updateBuzzerFromTargets() içinde)
+  updateTargetDisplay(markerOf(i), targetX_px, targetY_px, zone, move_ms);
+  updateStatusText();
+  if (renderLod >= LOD_TEXT) {
+    uint32_t fieldBytes0 = nextionTxBytes, fieldCycles0 = ESP.getCycleCount();
+    updateTextDisplays(polarRadius_cm, polarAngle_deg, doc_y_cm, doc_x_cm);
+    renderStats.fieldCyclesSum += ESP.getCycleCount() - fieldCycles0;
+    renderStats.fieldBytesSum  += nextionTxBytes - fieldBytes0;
+    renderStats.fieldCalls++;
+    rateCtl.fieldBytesAvg = (3 * rateCtl.fieldBytesAvg + (nextionTxBytes - fieldBytes0)) / 4;
+  } else if (!fieldsParked) {
+    // Bayatlayacak değerler ekranda kalmasın: alanlar bir kez "--" (ayrıntı dönünce yeniden yazılır)
+    clearFieldDisplays();
+    fieldsParked = true;
+  }
+
+  // 8. Ek hedefler öncelik sırasıyla, kare bütçesi yettiği kadar; yetmeyenlerin marker'ı bırakılır
+  int drawn = 1;
+  for (int s = 1; s < selCount; s++) {
+    int j = sel[s];
+    if ((int)(nextionTxBytes - frameStartBytes) + MARKER_UPDATE_BYTES > frameBudget) {
+      releaseMarker(markerOf(j));
+      renderStats.budgetDropped++;
+      continue;
+    }
+    int mx_cm = targets.x_cm[j], my_cm = targets.y_cm[j];
+    if (prediction_enabled) {
+      mx_cm += (int32_t)targets.vx_cms[j] * (int32_t)(horizon_ms + move_ms) / 1000;
+      my_cm += (int32_t)targets.vy_cms[j] * (int32_t)(horizon_ms + move_ms) / 1000;
+    }
+    int px, py;
+    mapTargetToPixels(mx_cm, my_cm, gridWidth_cm, px, py);
+    updateTargetDisplay(markerOf(j), px, py, targets.zone[j], move_ms);
+    drawn++;
   }
 
-  // 6. Güncelleme
-  sendCommand("page0.pic=" + String(backgroundPicId));
-  updateVehicleDisplay(currentMaxGridXMeters); 
-  updateTargetDisplay(targetX_px, targetY_px, targetColor);
-  updateTextDisplays(polarRadius_m, polarAngle_deg, doc_y_m, doc_x_m);
+  renderStats.markersSum += drawn;
+  endFrame();
+}
+
+// Kare komutları ref_stop/ref_star arasında: ekran ara durumları (marker'dan önce değişen arka plan)
+// çizmez, kare ref_star geldiğinde bir kerede görünür. Sıra: arka plan, katmanlar, araç, marker'lar, metin.
+void beginFrame() {
+  TIMING_SET(TIMING_FRAME_PIN, HIGH);
+  frameStartBytes    = nextionTxBytes;
+  frameStartCommands = nextionTxCommands;
+  frameCount         = 0;
+  beginNextionFrame();
+}
+
+void endFrame() {
+  SceneRenderer renderer = sceneRenderer();
+  if (renderer != RENDERER_COMPONENTS) flushDrawFrame();
+  endNextionFrame();
+  renderStats.cmdsSum[renderer] += nextionTxCommands - frameStartCommands;
+  renderStats.cmdFrames[renderer]++;
+
+  uint32_t frameBytes = nextionTxBytes - frameStartBytes;
+  int      backlog    = nextionTxBacklog();
+  uint32_t latency_ms = nextionTxLatency_ms();
+  renderStats.frames++;
+  renderStats.bytesSum += frameBytes;
+  if (frameBytes > renderStats.bytesMax) renderStats.bytesMax = frameBytes;
+  renderStats.latencySum_ms += latency_ms;
+  if (latency_ms > renderStats.latencyMax_ms) renderStats.latencyMax_ms = latency_ms;
+  if ((uint32_t)backlog > renderStats.backlogMax) renderStats.backlogMax = backlog;
+  rateCtl.frameBytesAvg = (3 * rateCtl.frameBytesAvg + frameBytes) / 4;
+
+  TIMING_SET(TIMING_FRAME_PIN, LOW);
+  TIMING_SET(TIMING_TX_PIN, HIGH);
 }
 
-void updateVehicleDisplay(float currentMaxGridXMeters) {
-  if (currentMaxGridXMeters < 0.1) currentMaxGridXMeters = 10.0;
+// move süresi: bir sonraki çizime kadar geçecek süre (ölçülen çizim aralığı). Animasyon kapalı ya da
+// paketli protokolde 0 (HMI zamanlayıcısı x/y'yi kendisi yazar).
+uint32_t moveDuration_ms() {
+  if (!(displayOptions & DISPLAY_OPT_MOVE) || (displayOptions & (DISPLAY_OPT_PACKED | DISPLAY_OPT_PRIMS))) return 0;
+  return constrain(renderCycle_ms, (uint32_t)MOVE_MIN_MS, (uint32_t)MOVE_MAX_MS);
+}
+
+// Kapalı döngü: ortalama kare baytını hattın hedef payına bölerek aralığı bulur, kuyruk birikiyorsa
+// aralığı %25 açar. Aralık üst sınıra yaklaşırsa önce metin, sonra renk/sahne tekrarı bırakılır.
+void updateRenderRate(unsigned long now) {
+  uint32_t elapsed_ms = now - rateCtl.last_ms;
+  if (elapsed_ms < RATE_CTRL_MS) return;
+  rateCtl.wireBps    = (nextionWireBytes - rateCtl.wireBytes0) * 1000UL / elapsed_ms;
+  rateCtl.wireBytes0 = nextionWireBytes;
+  rateCtl.last_ms    = now;
+  if (!renderRate_auto || rateCtl.frameBytesAvg == 0) return;
+
+  int backlog = nextionTxBacklog();
+  uint32_t desired_ms = rateCtl.frameBytesAvg * 1000UL / RATE_TARGET_BPS;
+  if (backlog > FRAME_BYTE_BUDGET / 2 && desired_ms < renderInterval_ms + renderInterval_ms / 4) {
+    desired_ms = renderInterval_ms + renderInterval_ms / 4;
+  }
+  renderInterval_ms = constrain(desired_ms, (uint32_t)RENDER_MIN_MS, (uint32_t)RENDER_MAX_MS);
+
+  if ((long)(now - rateCtl.lodHoldUntil_ms) < 0) return;
+  if (desired_ms > RENDER_LOD_DOWN_MS && renderLod > LOD_POSITION) {
+    renderLod--;
+    rateCtl.lodDowns++;
+    rateCtl.lodHoldUntil_ms = now + RATE_LOD_HOLD_MS;
+  } else if (renderLod < LOD_TEXT && backlog <= NEX_TX_HIGH_WATER) {
+    uint32_t extra = (renderLod == LOD_POSITION) ? LOD_COLOR_BYTES_EST
+                   : (rateCtl.fieldBytesAvg ? rateCtl.fieldBytesAvg : LOD_TEXT_BYTES_EST);
+    if ((rateCtl.frameBytesAvg + extra) * 1000UL / RATE_TARGET_BPS < RENDER_LOD_UP_MS) {
+      renderLod++;
+      rateCtl.lodUps++;
+      rateCtl.lodHoldUntil_ms = now + RATE_LOD_HOLD_MS;
+    }
+  }
+}
+
+// Gösterilecek hedefleri seçer (birincil + bölge/mesafe önceliğine göre ekler) ve marker'lara bağlar.
+// Seçilmeyen izlerin marker'ı bırakılır; izini sürdüğü hedef seçili kalan marker aynı kalır.
+int assignMarkers(int primary, int* sel) {
+  int n = 0;
+  sel[n++] = primary;
+  for (int i = 0; i < RADAR_SLOT_COUNT; i++) {
+    if (i == primary || !(targets.flags[i] & TGT_ACTIVE)) continue;
+    if (n == markerPoolSize && (n == 1 || !(targets.zone[i] > targets.zone[sel[n - 1]] ||
+        (targets.zone[i] == targets.zone[sel[n - 1]] && targets.r_cm[i] < targets.r_cm[sel[n - 1]])))) continue;
+
+    int k = n < markerPoolSize ? n++ : n - 1;
+    while (k > 1 && (targets.zone[i] > targets.zone[sel[k - 1]] ||
+           (targets.zone[i] == targets.zone[sel[k - 1]] && targets.r_cm[i] < targets.r_cm[sel[k - 1]]))) {
+      sel[k] = sel[k - 1];
+      k--;
+    }
+    sel[k] = i;
+  }
+
+  for (int k = 0; k < markerPoolSize; k++) {
+    if (markers[k].slot < 0) continue;
+    bool kept = false;
+    for (int s = 0; s < n; s++) kept |= (markers[k].slot == sel[s]);
+    if (!kept) releaseMarker(k);
+  }
+
+  for (int s = 0; s < n; s++) {
+    if (markerOf(sel[s]) >= 0) continue;
+    for (int k = 0; k < markerPoolSize; k++) {
+      if (markers[k].slot < 0) { markers[k].slot = sel[s]; break; }
+    }
+  }
+  return n;
+}
+
+int markerOf(int slot) {
+  for (int k = 0; k < markerPoolSize; k++) {
+    if (markers[k].slot == slot) return k;
+  }
+  return -1;
+}
+
+void releaseMarker(int k) {
+  if (k < 0) return;
+  MarkerState& m = markers[k];
+  if (m.shown && !(displayOptions & DISPLAY_OPT_PRIMS)) {  // Anlık çizimde kare farkı siler
+    uint32_t packed = packMarker(m.x, m.y, m.zone, false);
+    renderStats.sceneTextBytes   += 4 + markerCommandBytes(MARKER_NAME[k], ",", 0);
+    renderStats.scenePackedBytes += markerCommandBytes(MARKER_VAR[k], ".val=", packed);
+    if (displayOptions & DISPLAY_OPT_PACKED) sendCommand(String(MARKER_VAR[k]) + ".val=" + String(packed));
+    else                                     sendCommand("vis " + String(MARKER_NAME[k]) + ",0");
+  }
+  m.slot  = -1;
+  m.shown = false;
+}
+
+// Aynı slotun yeni ölçümü geldiğinde: hız modelinin o ana kestirdiği konum ile
+// ölçüm arasındaki fark (tahminli) ve son ölçümün kendisiyle fark (tahminsiz).
+void scorePrediction(int i, int16_t x_cm, int16_t y_cm) {
+  int32_t dt_ms = (int32_t)(targets.seen_ms[i] - predT0_ms);
+  int32_t ex = predX0_cm + (int32_t)predVx_cms * dt_ms / 1000 - x_cm;
+  int32_t ey = predY0_cm + (int32_t)predVy_cms * dt_ms / 1000 - y_cm;
+
+  predStats.samples++;
+  predStats.errPredictedSum_cm += abs(ex) + abs(ey);
+  predStats.errHeldSum_cm      += abs(predX0_cm - x_cm) + abs(predY0_cm - y_cm);
+  predSlot = -1;
+}
+
+// Ölçek = SCREEN_WIDTH_PX / grid. X: yanal + grid/2, Y: ekran altından ileri mesafe.
+void mapTargetToPixels(int x_cm, int y_cm, int gridWidth_cm, int& px, int& py) {
+  px = roundDiv((int32_t)(y_cm + gridWidth_cm / 2) * SCREEN_WIDTH_PX, gridWidth_cm);
+  py = roundDiv((int32_t)SCREEN_HEIGHT_PX * gridWidth_cm - (int32_t)x_cm * SCREEN_WIDTH_PX, gridWidth_cm);
+
+  px = constrain(px, 0, SCREEN_WIDTH_PX - TARGET_OBJECT_SIZE_PX);
+  py = constrain(py, 0, SCREEN_HEIGHT_PX - TARGET_OBJECT_SIZE_PX);
+}
+
+void vehicleGeometry(int gridWidth_cm, int& x_px, int& w_px) {
+  if (gridWidth_cm < 10) gridWidth_cm = DEFAULT_GRID_CM;
   
-  float fixedScale = (float)SCREEN_WIDTH_PX / currentMaxGridXMeters;
-  int vehicle_width_px = (int)((vehicleRealWidth_m * fixedScale) + 0.5);
+  w_px = roundDiv((int32_t)vehicleWidth_cm * SCREEN_WIDTH_PX, gridWidth_cm);
 
   // Araç genişliği ekranı taşarsa sınırla
-  if (vehicle_width_px > SCREEN_WIDTH_PX) vehicle_width_px = SCREEN_WIDTH_PX;
-  if (vehicle_width_px < 2) vehicle_width_px = 2;
+  if (w_px > SCREEN_WIDTH_PX) w_px = SCREEN_WIDTH_PX;
+  if (w_px < 2) w_px = 2;
 
-  int vehicle_x_px = (int)(((float)SCREEN_WIDTH_PX - vehicle_width_px) / 2.0 + 0.5);
-  if (vehicle_x_px < 0) vehicle_x_px = 0;
+  x_px = (SCREEN_WIDTH_PX - w_px + 1) / 2;
+}
+
+// Arka plan + yakın engeller + araç. Metin modunda her kare, paketli modda sahne değiştiğinde tek değişken.
+// Paketli modda resmi HMI zamanlayıcısı değiştirdiği için fill katmanı çizilmez (üzerine yazılırdı).
+void updateScene(int picId, int gridWidth_cm, int excludeCell) {
+  int vehicle_x_px, vehicle_width_px;
+  vehicleGeometry(gridWidth_cm, vehicle_x_px, vehicle_width_px);
+  uint32_t scene = packScene(picId, vehicle_x_px, vehicle_width_px);
+  uint8_t  scenePrio = (picId == PIC_ID_ALARM) ? NEX_PRIO_ALARM : NEX_PRIO_NORMAL;
+  if (displayOptions & DISPLAY_OPT_PRIMS) {
+    addDrawScene(picId, gridWidth_cm);
+    return;
+  }
+  if (renderLod < LOD_COLOR && (int32_t)scene == lastScene) return;  // Sadece konum: değişmeyen sahne tekrarlanmaz
+
+  // Metin modu resmi her karede, aracı geometri değişince yazar (updateVehicleDisplay)
+  bool vehicleChanged = lastScene < 0 || ((uint32_t)lastScene >> SCENE_VEH_X_SHIFT) != (scene >> SCENE_VEH_X_SHIFT);
+  renderStats.sceneTextBytes += commandBytes("page0.pic=", picId);
+  if (vehicleChanged) renderStats.sceneTextBytes += vehicleCommandBytes(vehicle_x_px, vehicle_width_px);
+  if ((int32_t)scene != lastScene) renderStats.scenePackedBytes += commandBytes("vScene.val=", scene);
+
+  if (displayOptions & DISPLAY_OPT_PACKED) {
+    if ((int32_t)scene != lastScene) sendCommand("vScene.val=" + String(scene), scenePrio);
+  } else {
+    sendCommand("page0.pic=" + String(picId), scenePrio);
+    if (occOptions & OCC_OPT_OVERLAY) drawOccupancyOverlay(gridWidth_cm, excludeCell);
+    updateVehicleDisplay(gridWidth_cm);
+  }
+  lastScene = scene;
+}
+
+// Protokol değişiminde: paketli modda sabit araç özellikleri bir kez gönderilir, önbellekler geçersiz.
+void applyDisplayProtocol() {
+  lastScene = -1;
+  drawnCount = 0;
+  drawFullPending = true;
+  sendCommand((displayOptions & DISPLAY_OPT_FLOW) ? "bkcmd=3" : "bkcmd=2");
+  if (displayOptions & DISPLAY_OPT_PRIMS) {  // Sayfa yüklenince bileşenler tasarım görünürlüğüne döner
+    sendCommand("vis rVehicle,0");
+    for (int k = 0; k < MARKER_POOL_SIZE; k++) sendCommand("vis " + String(MARKER_NAME[k]) + ",0");
+    return;
+  }
+  if (displayOptions & DISPLAY_OPT_PACKED) {
+    sendCommand("rVehicle.y=" + String(SCREEN_HEIGHT_PX - VEHICLE_HEIGHT_PX));
+    sendCommand("rVehicle.h=" + String(VEHICLE_HEIGHT_PX));
+    sendCommand("rVehicle.bco=" + String(VEHICLE_COLOR));
+  }
+}
+
+void updateVehicleDisplay(int gridWidth_cm) {
+  int vehicle_x_px, vehicle_width_px;
+  vehicleGeometry(gridWidth_cm, vehicle_x_px, vehicle_width_px);
+
+  int32_t geometry = ((int32_t)vehicle_x_px << 16) | vehicle_width_px;
+  if (!elementDue(EL_VEHICLE, geometry)) return;
+  if (!spendElement(EL_VEHICLE, geometry, vehicleCommandBytes(vehicle_x_px, vehicle_width_px))) return;
 
   sendCommand("rVehicle.x=" + String(vehicle_x_px));
   sendCommand("rVehicle.w=" + String(vehicle_width_px));
@@ -395,37 +1224,243 @@ void updateVehicleDisplay(float currentMaxGridXMeters) {
   sendCommand("rVehicle.bco=" + String(VEHICLE_COLOR));
 }
 
+int vehicleCommandBytes(int x_px, int w_px) {
+  return commandBytes("rVehicle.x=", x_px) + commandBytes("rVehicle.w=", w_px) +
+         commandBytes("rVehicle.y=", SCREEN_HEIGHT_PX - VEHICLE_HEIGHT_PX) +
+         commandBytes("rVehicle.h=", VEHICLE_HEIGHT_PX) + commandBytes("rVehicle.bco=", VEHICLE_COLOR);
+}
+
+// "Yakın engeller": en dolu birkaç hücre, arka plan resminden sonra gri kare olarak çizilir.
+// Çizilen hedefin hücresi ve komşuları marker ile çakışmasın diye atlanır.
+void drawOccupancyOverlay(int gridWidth_cm, int excludeCell) {
+  int     best[OCC_OVERLAY_MAX_CELLS];
+  uint8_t bestVal[OCC_OVERLAY_MAX_CELLS];
+  int n = 0;
+
+  for (int cell = 0; cell < GRID_CELLS; cell++) {
+    uint8_t v = occupancy[cell];
+    if (v < OCC_OVERLAY_MIN) continue;
+    if (excludeCell >= 0 && abs(cell % GRID_X_CELLS - excludeCell % GRID_X_CELLS) <= 1 &&
+        abs(cell / GRID_X_CELLS - excludeCell / GRID_X_CELLS) <= 1) continue;
+    if (n == OCC_OVERLAY_MAX_CELLS && v <= bestVal[n - 1]) continue;
+
+    int k = n < OCC_OVERLAY_MAX_CELLS ? n++ : n - 1;
+    while (k > 0 && bestVal[k - 1] < v) { best[k] = best[k - 1]; bestVal[k] = bestVal[k - 1]; k--; }
+    best[k] = cell;
+    bestVal[k] = v;
+  }
+
+  int cell_px = roundDiv((int32_t)GRID_CELL_CM * SCREEN_WIDTH_PX, gridWidth_cm);
+  if (cell_px < 2) cell_px = 2;
+
+  for (int k = 0; k < n; k++) {
+    int x_cm = (best[k] % GRID_X_CELLS) * GRID_CELL_CM;
+    int y_cm = (best[k] / GRID_X_CELLS - GRID_Y_CELLS / 2) * GRID_CELL_CM;
+    int px, py;
+    mapTargetToPixels(x_cm, y_cm, gridWidth_cm, px, py);
+    sendCommand("fill " + String(px) + "," + String(py) + "," + String(cell_px) + "," +
+                String(cell_px) + "," + String(OCC_OVERLAY_COLOR));
+  }
+}
+
 void clearDetection() {
   targetVisible = false;
+  renderedTarget = -1;
   buzzerShouldBeActive = false; 
   
-  sendCommand("vis rTarget,0");
-  sendCommand("page0.pic=" + String(PIC_ID_SAFE));
-  updateVehicleDisplay(10.0); // Varsayılan genişlik
+  beginFrame();
+  for (int k = 0; k < MARKER_POOL_SIZE; k++) releaseMarker(k);
+  updateScene(PIC_ID_SAFE, DEFAULT_GRID_CM, -1); // Varsayılan genişlik
   
-  sendCommand("tDurum.txt=\"Temiz\"");
-  sendCommand("tMesafe.txt=\"--\"");
-  sendCommand("tAci.txt=\"--\"");
-  sendCommand("tX.txt=\"--\"");
-  sendCommand("tY.txt=\"--\"");
+  clearFieldDisplays();
+  updateStatusText();
+  fieldsParked = false;
+  endFrame();
+}
+
+// Marker k'yı günceller: yeni atanmışsa görünür yapar, sadece değişen özellikleri gönderir.
+// Paketli modda değişen marker tek değişken yazar. move_ms > 0: görünür marker x/y yerine move ile kayar.
+void updateTargetDisplay(int k, int x, int y, uint8_t zone, uint32_t move_ms) {
+  MarkerState& m = markers[k];
+  targetVisible = true;
+
+  bool fresh = !m.shown;
+  // Sadece konum: alarm dışı renk değişimi ertelenir, marker eski rengini korur
+  if (!fresh && renderLod < LOD_COLOR && zone != m.zone && zone != ZONE_ALARM && m.zone != ZONE_ALARM) zone = m.zone;
+  bool zoneChanged = fresh || m.zone != zone, xChanged = fresh || m.x != x, yChanged = fresh || m.y != y;
+  uint32_t packed = packMarker(x, y, zone, true);
+  uint8_t  colorPrio = (zoneChanged && zone == ZONE_ALARM) ? NEX_PRIO_ALARM : NEX_PRIO_NORMAL;
+
+  if (zoneChanged) renderStats.sceneTextBytes += markerCommandBytes(MARKER_NAME[k], ".pco=", ZONE_COLOR[zone]);
+  if (xChanged)    renderStats.sceneTextBytes += markerCommandBytes(MARKER_NAME[k], ".x=", x);
+  if (yChanged)    renderStats.sceneTextBytes += markerCommandBytes(MARKER_NAME[k], ".y=", y);
+  if (fresh)       renderStats.sceneTextBytes += 4 + markerCommandBytes(MARKER_NAME[k], ",", 1);
+  if (zoneChanged || xChanged || yChanged) renderStats.scenePackedBytes += markerCommandBytes(MARKER_VAR[k], ".val=", packed);
+
+  if (displayOptions & DISPLAY_OPT_PRIMS) {
+    addDrawPrim(DRAW_FILL, x, y, TARGET_OBJECT_SIZE_PX, TARGET_OBJECT_SIZE_PX, ZONE_COLOR[zone]);
+    m.shown = true;
+    m.x     = x;
+    m.y     = y;
+    m.zone  = zone;
+    return;
+  }
+
+  bool moved = !fresh && (xChanged || yChanged);
+  String moveCmd;
+  if (moved) {
+    uint32_t cycle_ms = constrain(renderCycle_ms, (uint32_t)MOVE_MIN_MS, (uint32_t)MOVE_MAX_MS);
+    uint32_t xyBytes  = markerCommandBytes(MARKER_NAME[k], ".x=", x) + markerCommandBytes(MARKER_NAME[k], ".y=", y);
+    moveCmd = "move " + String(MARKER_NAME[k]) + "," + String(m.x) + "," + String(m.y) + "," + String(x) + "," +
+              String(y) + ",0," + String(move_ms ? move_ms : cycle_ms);
+    renderStats.markerXYBytes     += xyBytes;
+    renderStats.markerMoveBytes   += moveCmd.length() + 3;
+    renderStats.markerSmoothBytes += xyBytes * ((cycle_ms + MOVE_SMOOTH_FRAME_MS / 2) / MOVE_SMOOTH_FRAME_MS);
+  }
+
+  if (displayOptions & DISPLAY_OPT_PACKED) {
+    if (zoneChanged || xChanged || yChanged) sendCommand(String(MARKER_VAR[k]) + ".val=" + String(packed), colorPrio);
+  } else {
+    String name = MARKER_NAME[k];
+    if (zoneChanged) sendCommand(name + ".pco=" + String(ZONE_COLOR[zone]), colorPrio);
+    if (moved && move_ms > 0) {
+      sendCommand(moveCmd);
+    } else {
+      if (xChanged) sendCommand(name + ".x=" + String(x));
+      if (yChanged) sendCommand(name + ".y=" + String(y));
+    }
+    if (fresh)       sendCommand("vis " + name + ",1");
+  }
+
+  m.shown = true;
+  m.x     = x;
+  m.y     = y;
+  m.zone  = zone;
+}
+
+// Alanlar sınıf önceliğiyle (her kare, değişim, 4 Hz, 1 Hz) bütçeden gönderilir; zamanı gelip bütçeye
+// sığmayan alan sonraki karede yeniden denenir. Sayısal modda ilk gösterim tüm alanları bütçesiz yazar.
+void updateTextDisplays(int radius_cm, int angle, int x_cm, int y_cm) {
+  fieldsParked = false;
+  bool numeric = displayOptions & DISPLAY_OPT_NUMERIC;
+  bool fresh   = numeric && !numericShown;
+  int32_t v[FIELD_COUNT] = { radius_cm, angle, y_cm, x_cm };
+
+  if (fresh) {
+    for (int f = 0; f < FIELD_COUNT; f++) elementValue[f] = ELEMENT_UNKNOWN;  // Araç ve durum bu karede yazıldı
+  }
+
+  const uint8_t ORDER[4] = { REFRESH_FRAME, REFRESH_CHANGE, REFRESH_4HZ, REFRESH_1HZ };
+  for (int c = 0; c < 4; c++) {
+    for (int f = 0; f < FIELD_COUNT; f++) {
+      if (refreshClass[f] != ORDER[c] || !elementDue(f, v[f])) continue;
+      String cmd;
+      if (numeric)     cmd = String(FIELD_NUMERIC[f]) + ".val=" + String(v[f]);
+      else if (f == 0) cmd = "tMesafe.txt=\"" + formatMeters(radius_cm) + "m\"";
+      else if (f == 1) cmd = "tAci.txt=\"" + String(angle) + "d\"";
+      else if (f == 2) cmd = "tX.txt=\"Y: " + formatMeters(y_cm) + "\"";
+      else             cmd = "tY.txt=\"X: " + formatMeters(x_cm) + "\"";
+      if (spendElement(f, v[f], cmd.length() + 3)) sendCommand(cmd);
+    }
+  }
+
+  if (fresh) {
+    for (int f = 0; f < FIELD_COUNT; f++) sendCommand("vis " + String(FIELD_NUMERIC[f]) + ",1");
+    numericShown = true;
+  }
+}
+
+// Sınıfa göre zamanı geldi mi: her kare her zaman; 4 Hz / 1 Hz değiştiyse ve süre dolduysa; değişimde
+// değiştiyse. Ekrandaki değeri bilinmeyen öğe hemen gönderilir.
+bool elementDue(int el, int32_t value) {
+  if (elementValue[el] == ELEMENT_UNKNOWN) return true;
+  uint8_t cls = refreshClass[el];
+  if (cls == REFRESH_FRAME) return true;
+  if (value == elementValue[el]) return false;
+  return millis() - elementSent_ms[el] >= REFRESH_PERIOD_MS[cls];
+}
+
+// Kovadan düşer ve önbelleği günceller. Bilinmeyen değer (ilk gösterim) bütçe beklemez, kovayı borçlandırır.
+bool spendElement(int el, int32_t value, int cost) {
+  unsigned long now = millis();
+  uint32_t elapsed_ms = min(now - elementRefill_ms, 1000UL);  // Kova zaten 1 s'lik bütçede dolar
+  elementRefill_ms = now;
+  elementTokens_mB = min(elementTokens_mB + (int32_t)(elapsed_ms * elementBudget_Bps), (int32_t)elementBudget_Bps * 1000);
+
+  if (elementValue[el] != ELEMENT_UNKNOWN && cost * 1000 > elementTokens_mB) {
+    elementStats.budgetSkips++;
+    return false;
+  }
+  elementTokens_mB  -= cost * 1000;
+  elementValue[el]   = value;
+  elementSent_ms[el] = now;
+  elementStats.sent[el]++;
+  elementStats.bytes[el] += cost;
+  return true;
 }
 
-void updateTargetDisplay(int x, int y, int color) {
-  if (!targetVisible) {
-    sendCommand("vis rTarget,1");
-    targetVisible = true;
+void forgetElements() {
+  for (int el = 0; el < ELEMENT_COUNT; el++) elementValue[el] = ELEMENT_UNKNOWN;
+}
+
+// Hedef yokken: metin modunda "--", sayısal modda alanlar gizlenir (Xfloat "--" gösteremez).
+void clearFieldDisplays() {
+  for (int f = 0; f < FIELD_COUNT; f++) elementValue[f] = ELEMENT_UNKNOWN;
+  if (displayOptions & DISPLAY_OPT_NUMERIC) {
+    if (numericShown) {
+      for (int f = 0; f < FIELD_COUNT; f++) sendCommand("vis " + String(FIELD_NUMERIC[f]) + ",0");
+    }
+    numericShown = false;
+    return;
+  }
+  for (int f = 0; f < FIELD_COUNT; f++) sendCommand(String(FIELD_TEXT[f]) + ".txt=\"--\"");
+}
+
+// İki modda da aynı değişen değer dizisi; UART'a yazılmadan bayt ve çevrim ölçülür.
+// Sayısal mod kararlı durumda ölçülür (alanlar görünür, her turda tüm değerler değişir).
+void runFieldBenchmark() {
+  const int ROUNDS = 100;
+  uint8_t  savedOptions = displayOptions;
+  bool     savedShown   = numericShown;
+  uint32_t savedBytes   = nextionTxBytes;
+  uint8_t  savedClass[ELEMENT_COUNT];
+  ElementStats savedStats = elementStats;
+  uint32_t bytes[2], cycles[2];
+
+  // Kodlama karşılaştırması: her alan her kare, bütçesiz
+  memcpy(savedClass, refreshClass, sizeof(refreshClass));
+  memset(refreshClass, REFRESH_FRAME, sizeof(refreshClass));
+  nextionDryRun = true;
+  for (int mode = 0; mode < 2; mode++) {
+    displayOptions = mode ? (savedOptions | DISPLAY_OPT_NUMERIC) : (savedOptions & ~DISPLAY_OPT_NUMERIC);
+    numericShown = true;
+    uint32_t b0 = nextionTxBytes, t0 = ESP.getCycleCount();
+    for (int r = 0; r < ROUNDS; r++) {
+      elementTokens_mB = INT32_MAX / 2;
+      updateTextDisplays(100 + r * 7, r % 90 - 45, r * 13 - 600, 200 + r * 11);
+    }
+    cycles[mode] = (ESP.getCycleCount() - t0) / ROUNDS;
+    bytes[mode]  = (nextionTxBytes - b0) / ROUNDS;
   }
-  sendCommand("rTarget.pco=" + String(color));
-  sendCommand("rTarget.x=" + String(x));
-  sendCommand("rTarget.y=" + String(y));
+  nextionDryRun  = false;
+  displayOptions = savedOptions;
+  numericShown   = savedShown;
+  nextionTxBytes = savedBytes;
+  elementStats   = savedStats;
+  elementTokens_mB = 0;
+  memcpy(refreshClass, savedClass, sizeof(refreshClass));
+  forgetElements(); // Sonraki kare tüm alanları gönderir
+
+  Serial.printf("[BENCH] Hedef alanlari/kare: metin %u bayt %u cevrim, sayisal %u bayt %u cevrim\n",
+                bytes[0], cycles[0], bytes[1], cycles[1]);
 }
 
-void updateTextDisplays(float radius, int angle, float x_m, float y_m) {
-  sendCommand("tDurum.txt=\"HEDEF\"");
-  sendCommand("tMesafe.txt=\"" + String(radius, 2) + "m\"");
-  sendCommand("tAci.txt=\"" + String(angle) + "d\"");
-  sendCommand("tX.txt=\"Y: " + String(y_m, 2) + "\""); 
-  sendCommand("tY.txt=\"X: " + String(x_m, 2) + "\"");
+// cm -> "m.cc" (float String(v, 2) ile aynı metin, float'sız)
+String formatMeters(int cm) {
+  char buf[12];
+  unsigned int absCm = cm < 0 ? -cm : cm;
+  snprintf(buf, sizeof(buf), "%s%u.%02u", cm < 0 ? "-" : "", absCm / 100, absCm % 100);
+  return String(buf);
 }
 
 void handleBuzzer() {
@@ -439,7 +1474,9 @@ void handleBuzzer() {
     return;
   }
 
-  if (!buzzerShouldBeActive) {
+  // Hedef alarmı yoksa sensör hatası kendi (uzun, seyrek) desenini çalar
+  bool faultTone = !buzzerShouldBeActive && sensorFaultMask != 0;
+  if (!buzzerShouldBeActive && !faultTone) {
     if (buzzerIsOn) {
       digitalWrite(BUZZER_PIN, LOW);
       buzzerIsOn = false;
@@ -447,8 +1484,11 @@ void handleBuzzer() {
     return;
   }
 
+  unsigned long onDuration = faultTone ? FAULT_BEEP_ON_MS : BEEP_ON_DURATION_MS;
+  unsigned long interval   = faultTone ? FAULT_BEEP_INTERVAL_MS : currentBeepInterval;
+
   unsigned long currentTime = millis();
-  if (currentBeepInterval == 0) {
+  if (interval == 0) {
     if (!buzzerIsOn) {
       digitalWrite(BUZZER_PIN, HIGH);
       buzzerIsOn = true;
@@ -457,13 +1497,13 @@ void handleBuzzer() {
   }
 
   if (buzzerIsOn) {
-    if (currentTime - lastBuzzerToggleTime >= BEEP_ON_DURATION_MS) {
+    if (currentTime - lastBuzzerToggleTime >= onDuration) {
       digitalWrite(BUZZER_PIN, LOW);
       buzzerIsOn = false;
       lastBuzzerToggleTime = currentTime;
     }
   } else {
-    if (currentTime - lastBuzzerToggleTime >= currentBeepInterval) {
+    if (currentTime - lastBuzzerToggleTime >= interval) {
       digitalWrite(BUZZER_PIN, HIGH);
       buzzerIsOn = true;
       lastBuzzerToggleTime = currentTime;
@@ -489,7 +1529,46 @@ void loadSettingsFromEEPROM() {
     EEPROM.get(ADDR_AUDIOALARM_EN, audioAlarm_enabled);
     EEPROM.get(ADDR_SIDE_MARGIN, sideMargin_m);
     EEPROM.get(ADDR_MAX_WIDTH, maxWidth_m);
+    EEPROM.get(ADDR_SENSOR_TIMEOUT, sensorTimeout_ms);
+    EEPROM.get(ADDR_SENSOR_MASK, sensorExpectedMask);
+    EEPROM.get(ADDR_STEER_CAN_ID, steerCanId);
+    EEPROM.get(ADDR_WHEELBASE, wheelbase_cm);
+    EEPROM.get(ADDR_SPEED_CAN_ID, speedCanId);
+    EEPROM.get(ADDR_SPEED_OPTIONS, speedOptions);
+
+    // Eski düzende bu alanlar yok: aralık dışıysa varsayılanı kullan
+    if (sensorTimeout_ms < SENSOR_TIMEOUT_MIN_MS || sensorTimeout_ms > SENSOR_TIMEOUT_MAX_MS)
+      sensorTimeout_ms = DEFAULT_SENSOR_TIMEOUT_MS;
+    if (sensorExpectedMask == 0) sensorExpectedMask = DEFAULT_SENSOR_MASK;
+    if (steerCanId > 0x7FF) steerCanId = DEFAULT_STEER_CAN_ID;
+    if (wheelbase_cm < WHEELBASE_MIN_CM || wheelbase_cm > WHEELBASE_MAX_CM) wheelbase_cm = DEFAULT_WHEELBASE_CM;
+    if (speedCanId > 0x7FF) speedCanId = DEFAULT_SPEED_CAN_ID;
+    speedOptions &= SPEED_OPT_YAW;
+
+    clutterOptions = EEPROM.read(ADDR_CLUTTER_OPTIONS) & CLUTTER_OPT_ENABLE;
+    occOptions = EEPROM.read(ADDR_OCC_OPTIONS) & (OCC_OPT_OVERLAY | OCC_OPT_CONFIRM);
+    markerPoolSize = EEPROM.read(ADDR_MARKER_POOL);
+    if (markerPoolSize < 1 || markerPoolSize > MARKER_POOL_SIZE) markerPoolSize = DEFAULT_MARKER_POOL;
+    displayOptions = EEPROM.read(ADDR_DISPLAY_OPTIONS) & (DISPLAY_OPT_PACKED | DISPLAY_OPT_NUMERIC | DISPLAY_OPT_FLOW |
+                                                          DISPLAY_OPT_MOVE | DISPLAY_OPT_DRAW | DISPLAY_OPT_PROFILE | DISPLAY_OPT_TFT);
+    for (int el = 0; el < ELEMENT_COUNT; el++) {
+      uint8_t stored = EEPROM.read(ADDR_REFRESH_CLASSES + el);  // sınıf + 1; 0 = eski düzen, ayarlanmamış
+      refreshClass[el] = (stored >= 1 && stored <= REFRESH_CHANGE + 1) ? stored - 1 : DEFAULT_REFRESH_CLASS[el];
+    }
+    EEPROM.get(ADDR_ELEMENT_BUDGET, elementBudget_Bps);
+    if (elementBudget_Bps < ELEMENT_BUDGET_MIN_BPS || elementBudget_Bps > ELEMENT_BUDGET_MAX_BPS)
+      elementBudget_Bps = DEFAULT_ELEMENT_BUDGET_BPS;
+    EEPROM.get(ADDR_CLUTTER_MASK, clutterMask);
+
+    EEPROM.get(ADDR_POLY_ZONES, polyZones);
+    for (int z = 0; z < POLY_ZONE_MAX; z++) {
+      if (polyZones[z].level > ZONE_ALARM || polyZones[z].count > POLY_VERTEX_MAX) {
+        memset(&polyZones[z], 0, sizeof(PolyZone));
+      }
+    }
   }
+  applySettings();
+  applyDisplayProtocol();
   sendSettingsToNextion();
 }
 
@@ -503,10 +1582,26 @@ void saveSettingsToEEPROM() {
   EEPROM.put(ADDR_AUDIOALARM_EN, audioAlarm_enabled);
   EEPROM.put(ADDR_SIDE_MARGIN, sideMargin_m);
   EEPROM.put(ADDR_MAX_WIDTH, maxWidth_m);
+  EEPROM.put(ADDR_SENSOR_TIMEOUT, sensorTimeout_ms);
+  EEPROM.put(ADDR_SENSOR_MASK, sensorExpectedMask);
+  EEPROM.put(ADDR_STEER_CAN_ID, steerCanId);
+  EEPROM.put(ADDR_WHEELBASE, wheelbase_cm);
+  EEPROM.put(ADDR_SPEED_CAN_ID, speedCanId);
+  EEPROM.put(ADDR_SPEED_OPTIONS, speedOptions);
+  EEPROM.put(ADDR_CLUTTER_OPTIONS, clutterOptions);
+  EEPROM.put(ADDR_OCC_OPTIONS, occOptions);
+  EEPROM.put(ADDR_MARKER_POOL, markerPoolSize);
+  EEPROM.put(ADDR_DISPLAY_OPTIONS, displayOptions);
+  for (int el = 0; el < ELEMENT_COUNT; el++) EEPROM.write(ADDR_REFRESH_CLASSES + el, refreshClass[el] + 1);
+  EEPROM.put(ADDR_ELEMENT_BUDGET, elementBudget_Bps);
+  EEPROM.put(ADDR_POLY_ZONES, polyZones);
+  EEPROM.put(ADDR_CLUTTER_MASK, clutterMask);
   EEPROM.commit();
 }
 
 void resetToDefaults() {
+    for (int k = 0; k < MARKER_POOL_SIZE; k++) releaseMarker(k); // Protokol değişebilir, eski kodlamayla gizle
+    clearFieldDisplays();
     warningZone_m = DEFAULT_WARNING_ZONE_M;
     dangerZone_m = DEFAULT_DANGER_ZONE_M;
     vehicleRealWidth_m = DEFAULT_VEHICLE_WIDTH_M;
@@ -514,15 +1609,99 @@ void resetToDefaults() {
     audioAlarm_enabled = DEFAULT_AUDIOALARM_EN;
     sideMargin_m = DEFAULT_SIDE_MARGIN_M;
     maxWidth_m = DEFAULT_MAX_WIDTH_M;
+    sensorTimeout_ms = DEFAULT_SENSOR_TIMEOUT_MS;
+    sensorExpectedMask = DEFAULT_SENSOR_MASK;
+    steerCanId = DEFAULT_STEER_CAN_ID;
+    wheelbase_cm = DEFAULT_WHEELBASE_CM;
+    speedCanId = DEFAULT_SPEED_CAN_ID;
+    speedOptions = DEFAULT_SPEED_OPTIONS;
+    clutterOptions = DEFAULT_CLUTTER_OPTIONS;
+    occOptions = DEFAULT_OCC_OPTIONS;
+    markerPoolSize = DEFAULT_MARKER_POOL;
+    displayOptions = DEFAULT_DISPLAY_OPTIONS;
+    memcpy(refreshClass, DEFAULT_REFRESH_CLASS, sizeof(refreshClass));
+    elementBudget_Bps = DEFAULT_ELEMENT_BUDGET_BPS;
+    memset(polyZones, 0, sizeof(polyZones));
+    memset(clutterMask, 0, sizeof(clutterMask));
+    applySettings();
+    applyDisplayProtocol();
     saveSettingsToEEPROM();
 }
 
+// Float ayarlar (EEPROM / Nextion formatı) -> sıcak yolda kullanılan cm eşikleri
+void applySettings() {
+  warningZone_cm  = (int16_t)lroundf(warningZone_m * 100);
+  dangerZone_cm   = (int16_t)lroundf(dangerZone_m * 100);
+  vehicleWidth_cm = (int16_t)lroundf(vehicleRealWidth_m * 100);
+  halfCorridor_cm = vehicleWidth_cm / 2 + (int16_t)lroundf(sideMargin_m * 100);
+  updatePathModel();
+  rebuildZoneGrid();
+}
+
 void sendSettingsToNextion() {
-  sendCommand("pageSet1.h0.val=" + String((int)(warningZone_m * 10)));
-  sendCommand("pageSet1.h1.val=" + String((int)(dangerZone_m * 10)));
-  sendCommand("pageSet2.h0.val=" + String((int)(sideMargin_m * 10)));
-  sendCommand("pageSet2.h1.val=" + String((int)(vehicleRealWidth_m * 10)));
-  sendCommand("pageSet2.h2.val=" + String((int)(maxWidth_m * 10)));
-  sendCommand("pageSet3.btZoom.val=" + String(autoZoom_enabled ? 1 : 0));
-  sendCommand("pageSet3.btAudio.val=" + String(audioAlarm_enabled ? 1 : 0));
-}
\ No newline at end of file
+  for (int item = 0; item < SETTINGS_ITEM_COUNT; item++) sendSettingToNextion(item);
+}
+
+// Hat tam senkronu ayarları tek tek gönderebilsin diye komut başına bir madde.
+void sendSettingToNextion(int item) {
+  switch (item) {
+    case 0: sendCommand("pageSet1.h0.val=" + String((int)(warningZone_m * 10)), NEX_PRIO_LOW); break;
+    case 1: sendCommand("pageSet1.h1.val=" + String((int)(dangerZone_m * 10)), NEX_PRIO_LOW); break;
+    case 2: sendCommand("pageSet2.h0.val=" + String((int)(sideMargin_m * 10)), NEX_PRIO_LOW); break;
+    case 3: sendCommand("pageSet2.h1.val=" + String((int)(vehicleRealWidth_m * 10)), NEX_PRIO_LOW); break;
+    case 4: sendCommand("pageSet2.h2.val=" + String((int)(maxWidth_m * 10)), NEX_PRIO_LOW); break;
+    case 5: sendCommand("pageSet3.btZoom.val=" + String(autoZoom_enabled ? 1 : 0), NEX_PRIO_LOW); break;
+    case 6: sendCommand("pageSet3.btAudio.val=" + String(audioAlarm_enabled ? 1 : 0), NEX_PRIO_LOW); break;
+  }
+}
+
+// -------------------------------------------------------------------------------------------------
+// SABİT NOKTA DOĞRULAMASI (SELFTEST_FIXEDPOINT)
+// -------------------------------------------------------------------------------------------------
+// Tamsayı hattını v3.7.0 float hesabına karşı tüm data[2]/data[3] (65.536) kombinasyonunda bir zoom
+// kademesinde karşılaştırır. Masaüstü testi her profilde, SELFTEST_FIXEDPOINT açılışta cihazda çalıştırır.
+unsigned long fixedPointPixelMismatches(int zoom) {
+  const float GRID_M[4] = { 10.0, 8.0, 6.0, 4.0 };
+  float fixedScale = (float)SCREEN_WIDTH_PX / GRID_M[zoom];
+  unsigned long mismatches = 0;
+  for (int d2 = 0; d2 < 256; d2++) {
+    for (int d3 = 0; d3 < 256; d3++) {
+      float doc_x_m = d2 * 0.25;
+      float doc_y_m = ((int)d3 - 128) * 0.25;
+      float refX_float = (doc_y_m + (GRID_M[zoom] / 2.0)) * fixedScale;
+      float refY_float = (float)SCREEN_HEIGHT_PX - (doc_x_m * fixedScale);
+      int refX = constrain((int)(refX_float + 0.5), 0, SCREEN_WIDTH_PX - TARGET_OBJECT_SIZE_PX);
+      int refY = constrain((int)(refY_float + 0.5), 0, SCREEN_HEIGHT_PX - TARGET_OBJECT_SIZE_PX);
+
+      int px, py;
+      mapTargetToPixels(d2 * 25, (d3 - 128) * 25, ZONE_GRID_CM[zoom], px, py);
+      if (px != refX || py != refY) mismatches++;
+    }
+  }
+  return mismatches;
+}
+
+// Koridor ve bölge eşikleri mevcut ayarlarla, tüm ham mesafe/yanal değerlerde
+unsigned long fixedPointThresholdMismatches() {
+  unsigned long mismatches = 0;
+  for (int d = 0; d < 256; d++) {
+    float v_m  = d * 0.25;
+    int   v_cm = d * 25;
+    if ((v_m > warningZone_m) != (v_cm > warningZone_cm)) mismatches++;
+    if ((v_m > dangerZone_m)  != (v_cm > dangerZone_cm))  mismatches++;
+    if ((v_m <= 0.75)         != (v_cm <= SOLID_TONE_DISTANCE_CM)) mismatches++;
+
+    float y_m  = (d - 128) * 0.25;
+    int   y_cm = (d - 128) * 25;
+    if ((fabs(y_m) < (vehicleRealWidth_m / 2.0 + sideMargin_m)) != (abs(y_cm) < halfCorridor_cm)) mismatches++;
+  }
+  return mismatches;
+}
+
+#if SELFTEST_FIXEDPOINT == 1
+void selfTestFixedPoint() {
+  unsigned long mismatches = fixedPointThresholdMismatches();
+  for (int g = 0; g < 4; g++) mismatches += fixedPointPixelMismatches(g);
+  Serial.printf("[SELFTEST] Sabit nokta: %lu uyumsuzluk\n", mismatches);
+}
+#endif
@@ -0,0 +1,441 @@
+// Nextion çıkışı: öncelikli komut kuyruğu, bkcmd=3 akış kontrolü (kredi), hat sağlığı ve ekran
+// yeniden başladığında tam senkron, mesafe profili waveform aktarımı (addt).
+#include "radar.h"
+
+// -------------------------------------------------------------------------------------------------
+// ÇIKIŞ DURUMU
+// -------------------------------------------------------------------------------------------------
+HardwareSerial SerialNextion(2);
+
+// Öncelikli kuyruk ve sayaçlar
+NexQueued  nexQueue[NEX_QUEUE_LEN];
+int        nexQueueCount       = 0;
+int        nexQueuedBytes      = 0;
+bool       nexPriority_enabled = true;
+QueueStats queueStats;
+uint32_t   nexFrameSeq         = 0;
+uint32_t   nexFrameSeqWritten  = 0;
+bool       nexFrameOpen        = false;
+uint8_t    nexFramePrio        = NEX_PRIO_NORMAL;
+bool       nexFrameAlarm       = false;
+uint32_t   nexFrameAlarm_ms    = 0;
+bool       nexFrameClosing     = false;
+uint32_t   nextionTxBytes      = 0;
+uint32_t   nextionTxCommands   = 0;
+uint32_t   nextionWireBytes    = 0;
+bool       nextionDryRun       = false;
+bool       nexOutputDropped    = false;
+
+// Akış kontrolü ve hat sağlığı
+uint32_t      nexAckSent_ms[NEX_ACK_RING];
+uint16_t      nexAckBatch[NEX_ACK_RING];
+uint8_t       nexAckHead         = 0;
+uint8_t       nexAckSlots        = 0;
+uint16_t      nexAckCount        = 0;
+FlowStats     flowStats;
+bool          nextionLinkUp      = true;
+int           settingsResyncNext = SETTINGS_ITEM_COUNT;
+unsigned long linkResyncStart_ms = 0;
+LinkStats     linkStats;
+
+// Mesafe profili
+uint8_t       profileRing[PROFILE_POINTS];
+int           profileHead       = 0;
+int           profileFilled     = 0;
+int           profileUnsent     = 0;
+int           profileBurstStart = 0;
+int           profileBurstLen   = 0;
+ProfileState  profileState      = PROFILE_IDLE;
+unsigned long profileNext_ms    = 0;
+unsigned long profileStart_ms   = 0;
+ProfileStats  profileStats;
+
+// -------------------------------------------------------------------------------------------------
+// ÖNCELİKLİ ÇIKIŞ KUYRUĞU
+// -------------------------------------------------------------------------------------------------
+// Komut öncelikli kuyruğa girer; kuyruk UART tamponu NEX_TX_HIGH_WATER altındayken boşaltılır.
+void sendCommand(String cmd, uint8_t prio) {
+  nextionTxBytes += cmd.length() + 3;
+  nextionTxCommands++;
+  if (nextionDryRun) return;
+
+  const char* text = cmd.c_str();
+  int len = cmd.length();
+  bool alarm = (prio == NEX_PRIO_ALARM);
+  uint32_t alarmSince_ms = millis();
+  if (nexFrameOpen) {
+    // Kare ref_star ile görünür: alarm gecikmesi kareyi kapatan komutta ölçülür
+    if (alarm) raiseNextionFrame();
+    prio = nexFramePrio;  // Karenin parçası (alan, araç geometrisi) ref_star'ın arkasına kalmaz
+    if (refBatch_enabled) alarm = nexFrameClosing && nexFrameAlarm;
+    if (nexFrameClosing) alarmSince_ms = nexFrameAlarm_ms;
+  }
+  if (!nexPriority_enabled) prio = NEX_PRIO_NORMAL;
+  if (len >= NEX_CMD_MAX) {
+    // Kuyruk boşaltılamaz: addt ham verisi bozulur ya da (alarm değilse) kuyruk + komut krediye sığmaz
+    if (profileState != PROFILE_IDLE || (!alarm && nextionCredits() <= nexQueueCount)) {
+      dropNextionCommand();
+      return;
+    }
+    while (nexQueueCount > 0) writeNextQueued();
+    writeToNextion(text, len);
+    return;
+  }
+
+  // Anahtar: '=' öncesi, "vis <bileşen>," için bileşen adı
+  int keyLen = 0;
+  const char* eq = strchr(text, '=');
+  if (eq) keyLen = eq - text;
+  else if (strncmp(text, "vis ", 4) == 0 && strchr(text, ',')) keyLen = strchr(text, ',') - text;
+
+  if (nexPriority_enabled && keyLen > 0) {
+    for (int q = 0; q < nexQueueCount; q++) {
+      NexQueued& e = nexQueue[q];
+      if (e.keyLen != keyLen || memcmp(e.text, text, keyLen) != 0) continue;
+      queueStats.superseded++;
+      queueStats.supersededBytes += e.len + 3;
+      nexQueuedBytes += len - e.len;
+      memcpy(e.text, text, len + 1);
+      e.len = len;
+      if (alarm && !e.alarm) e.queued_ms = alarmSince_ms;  // Alarm bu komutla başladı
+      e.alarm = e.alarm || alarm;
+      if (prio < e.prio) e.prio = prio;
+      return;
+    }
+  }
+
+  // Hatta yazılamıyorsa (addt aktarımı, kredisiz sıradaki komut): alarm en yeni alarm olmayan komutun
+  // yerini alır, diğerleri düşer
+  if (nexQueueCount == NEX_QUEUE_LEN && !nextionCanWrite()) {
+    int victim = -1;
+    for (int q = nexQueueCount - 1; alarm && q >= 0 && victim < 0; q--) {
+      if (!nexQueue[q].alarm) victim = q;
+    }
+    dropNextionCommand();
+    if (victim < 0) return;
+    removeQueued(victim);
+  } else if (nexQueueCount == NEX_QUEUE_LEN) {
+    queueStats.forced++;
+    writeNextQueued();
+  }
+  NexQueued& e = nexQueue[nexQueueCount++];
+  memcpy(e.text, text, len + 1);
+  e.len       = len;
+  e.keyLen    = keyLen;
+  e.prio      = prio;
+  e.alarm     = alarm;
+  e.queued_ms = alarmSince_ms;
+  e.fifo_ms   = (uint32_t)(nextionTxBacklog() + len + 3) * 10000UL / NEXTION_BAUD;
+  e.frameSeq  = nexFrameOpen ? ++nexFrameSeq : 0;
+  nexQueuedBytes += len + 3;
+  if ((uint32_t)nexQueueCount > queueStats.depthMax) queueStats.depthMax = nexQueueCount;
+
+  pumpNextionQueue();
+}
+
+void writeToNextion(const char* text, int len) {
+  nextionWireBytes += len + 3;
+  if (displayOptions & DISPLAY_OPT_FLOW) trackCommandSent();
+  SerialNextion.write((const uint8_t*)text, len);
+  SerialNextion.write(0xFF);
+  SerialNextion.write(0xFF);
+  SerialNextion.write(0xFF);
+}
+
+void pumpNextionQueue() {
+  while (nexQueueCount > 0 && uartTxBacklog() < NEX_TX_HIGH_WATER) {
+    if (!nextionCanWrite()) {
+      if (profileState == PROFILE_IDLE) flowStats.held++;
+      break;
+    }
+    writeNextQueued();
+  }
+}
+
+// addt aktarımında araya komut girmemeli. FLOW: cevabı beklenen komut sayısı kredi sınırını aşmaz;
+// sıradaki alarm komutu (alarm karesinin tüm komutları) krediyi beklemez.
+bool nextionCanWrite() {
+  if (profileState != PROFILE_IDLE) return false;
+  if (nexQueueCount == 0 || nextionCredits() > 0) return true;
+  const NexQueued& e = nexQueue[nextQueued()];
+  return e.alarm || e.prio == NEX_PRIO_ALARM;
+}
+
+// En düşük öncelik değerli ilk komut (aynı öncelikte ekleme sırası korunur).
+int nextQueued() {
+  int best = 0;
+  for (int q = 1; q < nexQueueCount; q++) {
+    if (nexQueue[q].prio < nexQueue[best].prio) best = q;
+  }
+  return best;
+}
+
+void writeNextQueued() {
+  int best = nextQueued();
+  NexQueued& e = nexQueue[best];
+
+  if (e.alarm) {
+    uint32_t done_ms = millis() + (uint32_t)(uartTxBacklog() + e.len + 3) * 10000UL / NEXTION_BAUD;
+    uint32_t lat_ms  = done_ms - e.queued_ms;
+    queueStats.alarmCmds++;
+    queueStats.alarmLatSum_ms += lat_ms;
+    if (lat_ms > queueStats.alarmLatMax_ms) queueStats.alarmLatMax_ms = lat_ms;
+    if (e.fifo_ms > queueStats.alarmFifoMax_ms) queueStats.alarmFifoMax_ms = e.fifo_ms;
+  }
+
+  if (e.frameSeq) {
+    if (e.frameSeq < nexFrameSeqWritten) queueStats.frameReorders++;
+    else nexFrameSeqWritten = e.frameSeq;
+  }
+
+  writeToNextion(e.text, e.len);
+  removeQueued(best);
+}
+
+void removeQueued(int q) {
+  nexQueuedBytes -= nexQueue[q].len + 3;
+  nexQueueCount--;
+  memmove(&nexQueue[q], &nexQueue[q + 1], (nexQueueCount - q) * sizeof(NexQueued));
+}
+
+// TX halka tamponu + donanım FIFO'sunda gönderilmeyi bekleyen bayt sayısı
+// Hattan henüz çıkmamış bayt: UART tamponu + öncelikli kuyruk
+int nextionTxBacklog() {
+  return uartTxBacklog() + nexQueuedBytes;
+}
+
+int uartTxBacklog() {
+  int backlog = NEXTION_TX_BUFFER_SIZE + UART_HW_FIFO_LEN - SerialNextion.availableForWrite();
+  return backlog > 0 ? backlog : 0;
+}
+
+// 8N1: bayt başına 10 bit
+uint32_t nextionTxLatency_ms() {
+  return (uint32_t)nextionTxBacklog() * 10000UL / NEXTION_BAUD;
+}
+
+// Kare: ref_stop'tan ref_star'a tüm komutlar tek öncelikle girer; kuyruk aynı öncelikte sırayı korur,
+// kare parçalanmaz. Karede alarm komutu üretilince kare (ref_stop dahil) ve kuyrukta bekleyen önceki
+// kareler alarm önceliğine çıkar; yeni kare eskisinin önüne geçmez.
+void beginNextionFrame() {
+  nexFrameOpen  = true;
+  nexFramePrio  = NEX_PRIO_NORMAL;
+  nexFrameAlarm = false;
+  if (refBatch_enabled) sendCommand("ref_stop");
+}
+
+void endNextionFrame() {
+  nexFrameClosing = true;
+  if (refBatch_enabled) sendCommand("ref_star");
+  nexFrameClosing = false;
+  nexFrameOpen    = false;
+}
+
+void raiseNextionFrame() {
+  if (!nexFrameAlarm) nexFrameAlarm_ms = millis();
+  nexFrameAlarm = true;
+  if (!nexPriority_enabled) return;
+  nexFramePrio = NEX_PRIO_ALARM;
+  for (int q = 0; q < nexQueueCount; q++) {
+    if (nexQueue[q].frameSeq) nexQueue[q].prio = NEX_PRIO_ALARM;
+  }
+}
+
+// -------------------------------------------------------------------------------------------------
+// AKIŞ KONTROLÜ VE HAT SENKRONU
+// -------------------------------------------------------------------------------------------------
+// Halka dolunca (alarm komutları sınırı aşar) komut en yeni kayda eklenir: kredisi cevap ya da o
+// kaydın zaman aşımı gelene kadar tutulur.
+void trackCommandSent() {
+  if (nexAckSlots == NEX_ACK_RING) {
+    nexAckBatch[(nexAckHead + nexAckSlots - 1) % NEX_ACK_RING]++;
+    flowStats.merged++;
+  } else {
+    int slot = (nexAckHead + nexAckSlots) % NEX_ACK_RING;
+    nexAckSent_ms[slot] = millis();
+    nexAckBatch[slot]   = 1;
+    nexAckSlots++;
+  }
+  nexAckCount++;
+  if (nexAckCount > flowStats.outstandingMax) flowStats.outstandingMax = nexAckCount;
+}
+
+static void popAckSlot() {
+  nexAckHead = (nexAckHead + 1) % NEX_ACK_RING;
+  nexAckSlots--;
+}
+
+void clearNextionAcks() {
+  nexAckSlots = 0;
+  nexAckCount = 0;
+}
+
+// Hata kodları her modda sayılır (bkcmd=2 varsayılanı da hataları döndürür); RTT sadece akış kontrolünde.
+void onNextionReturn(uint8_t code) {
+  if ((displayOptions & DISPLAY_OPT_FLOW) && nexAckCount > 0) {
+    uint32_t rtt_ms = millis() - nexAckSent_ms[nexAckHead];
+    if (--nexAckBatch[nexAckHead] == 0) popAckSlot();
+    nexAckCount--;
+    flowStats.acks++;
+    flowStats.rttSum_ms += rtt_ms;
+    if (rtt_ms > flowStats.rttMax_ms) flowStats.rttMax_ms = rtt_ms;
+  }
+  if (code == NEX_RET_SUCCESS) return;
+
+  int kind = 0;
+  while (kind < NEX_ERROR_KINDS && NEX_ERRORS[kind].code != code) kind++;
+  flowStats.errors[kind]++;
+  NEXTION_PRINTF("[NEXTION] Hata 0x%02X\n", code);
+}
+
+void expireNextionAcks(unsigned long now) {
+  while (nexAckSlots > 0 && now - nexAckSent_ms[nexAckHead] > NEX_ACK_TIMEOUT_MS) {
+    nexAckCount -= nexAckBatch[nexAckHead];
+    flowStats.timeouts += nexAckBatch[nexAckHead];
+    popAckSlot();
+  }
+}
+
+int nextionCredits() {
+  if (!(displayOptions & DISPLAY_OPT_FLOW)) return NEX_CREDIT_LIMIT;
+  return NEX_CREDIT_LIMIT - nexAckCount;
+}
+
+void superviseNextionLink(unsigned long now) {
+  if (!nextionLinkUp || now - rxLast_ms <= NEXTION_LINK_TIMEOUT_MS) return;
+  nextionLinkUp = false;
+  linkStats.timeouts++;
+  Serial.println("[NEXTION] Hat cevap vermiyor");
+}
+
+// Yeniden açılan ekran açılış sayfasındadır ve bekleyen komutlara cevap vermez.
+static void forgetRebootedDisplay() {
+  clearNextionAcks();
+  nextionPage = NEX_PAGE_MAIN;
+}
+
+// Sadece kopan hatta ekran sayfası bilinmez; sendme cevabı zaten geliyordur. Açılışta 00 00 00 ardından
+// 0x88 gelir: süren senkron ikinci tetikte baştan başlamaz.
+void startLinkResync(bool rebooted) {
+  if (rebooted) forgetRebootedDisplay();
+  if (nextionLinkUp && settingsResyncNext < SETTINGS_ITEM_COUNT) {
+    linkStats.ignored++;
+    return;
+  }
+  Serial.printf("[NEXTION] %s: tam senkron\n", rebooted ? "Ekran yeniden basladi" : "Hat geri geldi");
+  nextionLinkUp = true;
+  pageResyncPending  = true;
+  settingsResyncNext = 0;
+  linkResyncStart_ms = millis();
+  linkStats.resyncs++;
+}
+
+// Öncelik: önce sahne (ana sayfadaysa loop'taki tam kare), sonra TX kuyruğu boşaldıkça döngü başına
+// bir ayar komutu. Ana sayfa dışındayken sahne bekler, ayarlar hemen başlar.
+void stepLinkResync() {
+  if (settingsResyncNext >= SETTINGS_ITEM_COUNT) return;
+  if (pageResyncPending && nextionPage == NEX_PAGE_MAIN) return;
+  if (nextionTxBacklog() > 0) return;
+
+  sendSettingToNextion(settingsResyncNext++);
+  if (settingsResyncNext == SETTINGS_ITEM_COUNT) {
+    uint32_t took_ms = millis() - linkResyncStart_ms;
+    if (took_ms > linkStats.resyncMax_ms) linkStats.resyncMax_ms = took_ms;
+  }
+}
+
+// -------------------------------------------------------------------------------------------------
+// MESAFE PROFİLİ (addt)
+// -------------------------------------------------------------------------------------------------
+void recordRangeProfile(int nearest) {
+  int value = 0;  // Hedef yok
+  if (nearest >= 0) {
+    int r_cm = constrain((int)targets.r_cm[nearest], 0, PROFILE_RANGE_CM);
+    value = PROFILE_HEIGHT_PX - roundDiv((int32_t)r_cm * PROFILE_HEIGHT_PX, PROFILE_RANGE_CM);
+  }
+  profileRing[profileHead] = value;
+  profileHead = (profileHead + 1) % PROFILE_POINTS;
+  if (profileFilled < PROFILE_POINTS) profileFilled++;
+  if (profileUnsent < PROFILE_POINTS) profileUnsent++;
+}
+
+// Saniyede bir, ana sayfada ve TX boşken: addt doğrudan yazılır, ham veri 0xFE cevabını bekler.
+// Cevap gelmezse kuyruk PROFILE_TIMEOUT_MS sonra serbest kalır.
+void stepRangeProfile(unsigned long now) {
+  if (profileState != PROFILE_IDLE) {
+    if (now - profileStart_ms <= PROFILE_TIMEOUT_MS) return;
+    profileStats.timeouts++;
+    NEXTION_PRINTF("[NEXTION] addt cevapsiz\n");
+    endRangeProfile();
+    return;
+  }
+  if (!(displayOptions & DISPLAY_OPT_PROFILE) || profileUnsent == 0) return;
+  if ((long)(now - profileNext_ms) < 0 || nextionPage != NEX_PAGE_MAIN || pageResyncPending) return;
+  if (nextionTxBacklog() > 0) return;
+  if (alarmTarget >= 0 && targets.zone[alarmTarget] == ZONE_ALARM) {
+    profileStats.deferred++;
+    profileNext_ms = now + PROFILE_PERIOD_MS;
+    return;
+  }
+
+  profileNext_ms  = now + PROFILE_PERIOD_MS;
+  profileBurstLen   = profileUnsent;
+  profileBurstStart = (profileHead - profileBurstLen + PROFILE_POINTS) % PROFILE_POINTS;
+  String cmd = "addt sProfile.id,0," + String(profileBurstLen);
+  nextionTxBytes += cmd.length() + 3;
+  nextionTxCommands++;
+  if (nextionDryRun) return;
+  writeToNextion(cmd.c_str(), cmd.length());
+  profileState    = PROFILE_WAIT_READY;
+  profileStart_ms = now;
+}
+
+void onProfileReturn(uint8_t code) {
+  if (code == NEX_RET_ADDT_READY && profileState == PROFILE_WAIT_READY) {
+    // Eskiden yeniye; halka sonu aşılırsa iki parça
+    int first = min(profileBurstLen, PROFILE_POINTS - profileBurstStart);
+    SerialNextion.write(&profileRing[profileBurstStart], first);
+    if (first < profileBurstLen) SerialNextion.write(profileRing, profileBurstLen - first);
+    for (int n = 0; n < profileBurstLen; n++) {
+      profileStats.addBytes += commandBytes("add sProfile.id,0,", profileRing[(profileBurstStart + n) % PROFILE_POINTS]);
+    }
+    nextionTxBytes   += profileBurstLen;
+    nextionWireBytes += profileBurstLen;
+    profileState = PROFILE_SENDING;
+    return;
+  }
+  if (code != NEX_RET_ADDT_DONE || profileState != PROFILE_SENDING) return;
+
+  if (displayOptions & DISPLAY_OPT_FLOW) onNextionReturn(NEX_RET_SUCCESS);
+  uint32_t hold_ms = millis() - profileStart_ms;
+  if (hold_ms > profileStats.maxHold_ms) profileStats.maxHold_ms = hold_ms;
+  profileStats.bursts++;
+  profileStats.points += profileBurstLen;
+  profileStats.bytes  += commandBytes("addt sProfile.id,0,", profileBurstLen) + profileBurstLen;
+  profileUnsent = max(0, profileUnsent - profileBurstLen);  // Aktarım sırasında gelen yeni noktalar kalır
+  endRangeProfile();
+}
+
+void endRangeProfile() {
+  profileState = PROFILE_IDLE;
+  recoverDroppedOutput();
+  pumpNextionQueue();
+}
+
+// Yazılamayan komut düştü (addt aktarımı ya da akış kontrolünde kredi yok)
+void dropNextionCommand() {
+  if (profileState != PROFILE_IDLE) profileStats.dropped++;
+  else                              flowStats.dropped++;
+  nexOutputDropped = true;
+}
+
+// Hat serbest. Düşen komut varsa ekrandaki bileşenler bilinmiyor: sonraki kare hepsini yeniden
+// gönderir (waveform sağlam, gönderilmemiş noktalar aynı kalır).
+void recoverDroppedOutput() {
+  if (!nexOutputDropped) return;
+  int unsent = profileUnsent;
+  nexOutputDropped = false;
+  invalidateDisplayCache();
+  profileUnsent = unsent;
+  renderDirty   = true;
+}
@@ -0,0 +1,420 @@
+// Şekil sahnesi (RENDER DRAW / RENDER TFT): kare boyunca toplanan şekiller önceki kareyle karşılaştırılır,
+// fark seçili çıkışa verilir: Nextion fill/line/cir ya da piksel hedefine (SPI TFT, masaüstü çerçeve
+// tamponu) şerit şerit rasterize.
+#include "radar.h"
+
+// -------------------------------------------------------------------------------------------------
+// SAHNE DURUMU
+// -------------------------------------------------------------------------------------------------
+DrawPrim drawnPrims[DRAW_PRIM_MAX];
+DrawPrim framePrims[DRAW_PRIM_MAX];
+int      drawnCount      = 0;
+int      frameCount      = 0;
+bool     drawFullPending = true;
+
+const PixelSink* pixelSink = NULL;
+RasterStats      rasterStats;
+
+// Bu karede yeniden rasterize edilecek bölgeler (birleştirilmiş kirli dikdörtgenler)
+struct RasterRect { int16_t x0, y0, x1, y1; };
+static RasterRect rasterRegions[RASTER_REGION_MAX];
+static int        rasterRegionCount = 0;
+
+#if DISPLAY_TFT == 1
+static spi_device_handle_t tftSpi = NULL;
+static uint16_t*           tftBand[2] = { NULL, NULL };   // DMA belleği, RGB565 büyük uçlu
+static spi_transaction_t   tftTrans[2];
+static int                 tftBandNext   = 0;
+static int                 tftDmaPending = 0;
+#endif
+
+// -------------------------------------------------------------------------------------------------
+// ŞEKİL SAHNESİ
+// -------------------------------------------------------------------------------------------------
+void addDrawPrim(uint8_t kind, int x, int y, int w, int h, int color) {
+  if (frameCount == DRAW_PRIM_MAX) return;
+  DrawPrim& p = framePrims[frameCount++];
+  p.kind  = kind;
+  p.x     = x;
+  p.y     = y;
+  p.w     = w;
+  p.h     = h;
+  p.color = color;
+}
+
+// Arka plan resmi yerine: bölge rengi şerit, uyarı/tehlike yayları (araç önü merkezli), koridor ve araç.
+// Poligon bölgeleri açıkken yarıçap eşikleri kullanılmadığı için yay ve koridor çizilmez.
+void addDrawScene(int picId, int gridWidth_cm) {
+  int zone = 0;
+  while (zone < ZONE_ALARM && ZONE_PIC_ID[zone] != picId) zone++;
+  addDrawPrim(DRAW_FILL, 0, 0, SCREEN_WIDTH_PX, DRAW_ZONE_BAR_PX, ZONE_COLOR[zone]);
+
+  if (!polyZonesActive) {
+    int cx = SCREEN_WIDTH_PX / 2;
+    addDrawPrim(DRAW_CIRCLE, cx, SCREEN_HEIGHT_PX, roundDiv((int32_t)warningZone_cm * SCREEN_WIDTH_PX, gridWidth_cm), 0,
+                COLOR_YELLOW);
+    addDrawPrim(DRAW_CIRCLE, cx, SCREEN_HEIGHT_PX, roundDiv((int32_t)dangerZone_cm * SCREEN_WIDTH_PX, gridWidth_cm), 0,
+                COLOR_RED);
+    int half_px = roundDiv((int32_t)halfCorridor_cm * SCREEN_WIDTH_PX, gridWidth_cm);
+    int top_y   = DRAW_ZONE_BAR_PX;
+    int base_y  = SCREEN_HEIGHT_PX - VEHICLE_HEIGHT_PX - 1;
+    if (half_px < cx) {
+      addDrawPrim(DRAW_LINE, cx - half_px, base_y, cx - half_px, top_y, DRAW_CORRIDOR_COLOR);
+      addDrawPrim(DRAW_LINE, cx + half_px, base_y, cx + half_px, top_y, DRAW_CORRIDOR_COLOR);
+    }
+  }
+
+  int vehicle_x_px, vehicle_width_px;
+  vehicleGeometry(gridWidth_cm, vehicle_x_px, vehicle_width_px);
+  addDrawPrim(DRAW_FILL, vehicle_x_px, SCREEN_HEIGHT_PX - VEHICLE_HEIGHT_PX, vehicle_width_px, VEHICLE_HEIGHT_PX,
+              VEHICLE_COLOR);
+}
+
+static bool samePrim(const DrawPrim& a, const DrawPrim& b) {
+  return a.kind == b.kind && a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h && a.color == b.color;
+}
+
+// Şeklin ekranda kapladığı kutu (ekrana kırpılmış): x0,y0 dahil, x1,y1 hariç
+static void primBounds(const DrawPrim& p, int& x0, int& y0, int& x1, int& y1) {
+  if (p.kind == DRAW_CIRCLE) {
+    x0 = p.x - p.w; y0 = p.y - p.w; x1 = p.x + p.w + 1; y1 = p.y + p.w + 1;
+  } else if (p.kind == DRAW_LINE) {
+    x0 = min(p.x, p.w); y0 = min(p.y, p.h); x1 = max(p.x, p.w) + 1; y1 = max(p.y, p.h) + 1;
+  } else {
+    x0 = p.x; y0 = p.y; x1 = p.x + p.w; y1 = p.y + p.h;
+  }
+  x0 = constrain(x0, 0, SCREEN_WIDTH_PX);  x1 = constrain(x1, 0, SCREEN_WIDTH_PX);
+  y0 = constrain(y0, 0, SCREEN_HEIGHT_PX); y1 = constrain(y1, 0, SCREEN_HEIGHT_PX);
+}
+
+// --- Nextion çizim komutları ---
+// Çizimler karenin parçasıdır (beginNextionFrame): cls, silme ve çizim tek öncelikle girer, silme
+// kendinden sonra üretilen çizimin önüne geçemez. Alarm karesi önceki kareleriyle birlikte yükselir.
+static void sendDrawCommand(const String& cmd) {
+  sendCommand(cmd, nexFrameAlarm ? NEX_PRIO_ALARM : NEX_PRIO_NORMAL);
+}
+
+static void nexBeginScene(bool alarm) {
+  if (alarm) raiseNextionFrame();
+}
+
+static void nexClearScene() {
+  sendDrawCommand("cls " + String(DRAW_BG_COLOR));
+  sendDrawCommand("ref tDurum");
+  if (displayOptions & DISPLAY_OPT_PROFILE) sendDrawCommand("ref sProfile");
+  for (int f = 0; f < FIELD_COUNT; f++) {
+    sendDrawCommand("ref " + String((displayOptions & DISPLAY_OPT_NUMERIC) ? FIELD_NUMERIC[f] : FIELD_TEXT[f]));
+  }
+}
+
+static void nexEraseRect(int x0, int y0, int x1, int y1) {
+  sendDrawCommand("fill " + String(x0) + "," + String(y0) + "," + String(x1 - x0) + "," + String(y1 - y0) + "," +
+                  String(DRAW_BG_COLOR));
+}
+
+static void nexDrawPrim(const DrawPrim& p) {
+  if (p.kind == DRAW_CIRCLE) {
+    sendDrawCommand("cir " + String(p.x) + "," + String(p.y) + "," + String(p.w) + "," + String(p.color));
+  } else if (p.kind == DRAW_LINE) {
+    sendDrawCommand("line " + String(p.x) + "," + String(p.y) + "," + String(p.w) + "," + String(p.h) + "," +
+                    String(p.color));
+  } else {
+    sendDrawCommand("fill " + String(p.x) + "," + String(p.y) + "," + String(p.w) + "," + String(p.h) + "," +
+                    String(p.color));
+  }
+}
+
+const SceneBackend NEXTION_BACKEND = { nexBeginScene, nexClearScene, nexEraseRect, nexDrawPrim, NULL, false };
+
+#if DISPLAY_TFT == 1
+// --- SPI TFT piksel hedefi: pencere komutları, iki şerit tamponu, DMA ---
+static void tftWaitDma(int keep) {
+  while (tftDmaPending > keep) {
+    spi_transaction_t* done;
+    spi_device_get_trans_result(tftSpi, &done, portMAX_DELAY);
+    tftDmaPending--;
+  }
+}
+
+// Komutlar kısa ve DC değiştirir: önce kuyruktaki tüm DMA biter, sonra bloklayan gönderim
+static void tftCommand(uint8_t cmd, const uint8_t* data, int len) {
+  tftWaitDma(0);
+  spi_transaction_t t;
+  memset(&t, 0, sizeof(t));
+  t.length     = 8;
+  t.flags      = SPI_TRANS_USE_TXDATA;
+  t.tx_data[0] = cmd;
+  digitalWrite(TFT_PIN_DC, LOW);
+  spi_device_polling_transmit(tftSpi, &t);
+  digitalWrite(TFT_PIN_DC, HIGH);
+  if (len == 0) return;
+  memset(&t, 0, sizeof(t));
+  t.length    = len * 8;
+  t.tx_buffer = data;
+  spi_device_polling_transmit(tftSpi, &t);
+}
+
+static void tftSetWindow(int x0, int y0, int x1, int y1) {
+  uint8_t cols[4] = { (uint8_t)(x0 >> 8), (uint8_t)x0, (uint8_t)((x1 - 1) >> 8), (uint8_t)(x1 - 1) };
+  uint8_t rows[4] = { (uint8_t)(y0 >> 8), (uint8_t)y0, (uint8_t)((y1 - 1) >> 8), (uint8_t)(y1 - 1) };
+  tftCommand(0x2A, cols, 4);  // CASET
+  tftCommand(0x2B, rows, 4);  // RASET
+  tftCommand(0x2C, NULL, 0);  // RAMWR: ardından gelen veri pencereyi satır satır doldurur
+}
+
+// Bir şerit hazırlanırken öteki gönderilir; tampon yeniden kullanılmadan önce onun aktarımı beklenir
+static uint16_t* tftNextBand() {
+  if (tftDmaPending == 2) {
+    rasterStats.dmaWaits++;
+    tftWaitDma(1);
+  }
+  return tftBand[tftBandNext];
+}
+
+static void tftPushBand(uint16_t* buf, int pixels) {
+  spi_transaction_t& t = tftTrans[tftBandNext];
+  memset(&t, 0, sizeof(t));
+  t.length    = pixels * 16;
+  t.tx_buffer = buf;
+  spi_device_queue_trans(tftSpi, &t, portMAX_DELAY);
+  tftDmaPending++;
+  tftBandNext ^= 1;
+}
+
+const PixelSink TFT_SINK = { tftNextBand, tftSetWindow, tftPushBand };
+
+bool tftBegin() {
+  spi_bus_config_t bus;
+  memset(&bus, 0, sizeof(bus));
+  bus.mosi_io_num     = TFT_PIN_MOSI;
+  bus.miso_io_num     = -1;
+  bus.sclk_io_num     = TFT_PIN_SCLK;
+  bus.quadwp_io_num   = -1;
+  bus.quadhd_io_num   = -1;
+  bus.max_transfer_sz = RASTER_BAND_PIXELS * 2;
+  spi_device_interface_config_t dev;
+  memset(&dev, 0, sizeof(dev));
+  dev.clock_speed_hz = TFT_SPI_HZ;
+  dev.mode           = 0;
+  dev.spics_io_num   = TFT_PIN_CS;
+  dev.queue_size     = 2;
+  for (int b = 0; b < 2; b++) tftBand[b] = (uint16_t*)heap_caps_malloc(RASTER_BAND_PIXELS * 2, MALLOC_CAP_DMA);
+  if (!tftBand[0] || !tftBand[1] || spi_bus_initialize(SPI3_HOST, &bus, SPI_DMA_CH_AUTO) != ESP_OK ||
+      spi_bus_add_device(SPI3_HOST, &dev, &tftSpi) != ESP_OK) {
+    Serial.println("[HATA] TFT SPI baslatilamadi!");
+    return false;
+  }
+
+  pinMode(TFT_PIN_DC, OUTPUT);
+  pinMode(TFT_PIN_RST, OUTPUT);
+  digitalWrite(TFT_PIN_RST, LOW);
+  delay(10);
+  digitalWrite(TFT_PIN_RST, HIGH);
+  delay(120);
+  tftCommand(0x11, NULL, 0);  // SLPOUT
+  delay(120);
+  uint8_t colmod = 0x55;      // 16 bit RGB565
+#if TFT_CONTROLLER == TFT_CONTROLLER_ST7789
+  uint8_t madctl = 0x00;
+  tftCommand(0x21, NULL, 0);  // INVON: ST7789 paneller ters renkli
+#else
+  uint8_t madctl = 0x48;      // MX | BGR, dikey
+#endif
+  tftCommand(0x3A, &colmod, 1);
+  tftCommand(0x36, &madctl, 1);
+  tftCommand(0x29, NULL, 0);  // DISPON
+  drawFullPending = true;
+  pixelSink = &TFT_SINK;
+  Serial.printf("[INFO] TFT %dx%d, SPI %d MHz, DMA serit %d satir\n", SCREEN_WIDTH_PX, SCREEN_HEIGHT_PX,
+                TFT_SPI_HZ / 1000000, RASTER_BAND_LINES);
+  return true;
+}
+#endif
+
+// --- Piksel çıkışı: kirli bölgeler, şerit rasterizasyonu ---
+// Çakışan bölgeler birleştirilir: bir piksel karede en fazla bir kez gönderilir
+static void rasterAddRegion(int x0, int y0, int x1, int y1) {
+  if (x1 <= x0 || y1 <= y0) return;
+  for (int i = 0; i < rasterRegionCount;) {
+    RasterRect& r = rasterRegions[i];
+    if (x0 < r.x1 && r.x0 < x1 && y0 < r.y1 && r.y0 < y1) {
+      x0 = min(x0, (int)r.x0); y0 = min(y0, (int)r.y0); x1 = max(x1, (int)r.x1); y1 = max(y1, (int)r.y1);
+      rasterRegions[i] = rasterRegions[--rasterRegionCount];
+      i = 0;
+    } else {
+      i++;
+    }
+  }
+  RasterRect r = { (int16_t)x0, (int16_t)y0, (int16_t)x1, (int16_t)y1 };
+  rasterRegions[rasterRegionCount++] = r;
+}
+
+static void rasterClearScene() {
+  rasterRegionCount = 0;
+  rasterAddRegion(0, 0, SCREEN_WIDTH_PX, SCREEN_HEIGHT_PX);
+}
+
+static void rasterDrawPrim(const DrawPrim& p) {
+  int x0, y0, x1, y1;
+  primBounds(p, x0, y0, x1, y1);
+  rasterAddRegion(x0, y0, x1, y1);
+}
+
+static inline void rasterPlot(uint16_t* buf, int bx, int by, int bw, int bh, int x, int y, uint16_t c) {
+  if (x >= bx && x < bx + bw && y >= by && y < by + bh) buf[(y - by) * bw + (x - bx)] = c;
+}
+
+// Bölgeye değen şekil ve bölgeye kırpılmış kutusu: şerit döngüsü sadece satır aralığı şeride değenleri çizer
+struct RasterClip { int16_t prim, x0, y0, x1, y1; };
+static RasterClip rasterClips[DRAW_PRIM_MAX];
+
+// Şekli şerit tamponuna (bx,by,bw,bh) kırparak çizer; cir/line Nextion gibi 1 piksel çerçeve/çizgi.
+// Kutu şeride kırpılmıştır: dolgu doğrudan yazılır, çizgi şeridi geçince, çember şeride düşen satırları
+// bitince durur.
+static void rasterPrim(const DrawPrim& p, const RasterClip& clip, uint16_t* buf, int bx, int by, int bw, int bh) {
+  uint16_t c = (uint16_t)((p.color >> 8) | (p.color << 8));
+  int by1 = by + bh;
+
+  if (p.kind == DRAW_FILL) {
+    int y0 = max((int)clip.y0, by), y1 = min((int)clip.y1, by1);
+    for (int y = y0; y < y1; y++) {
+      uint16_t* row = buf + (y - by) * bw - bx;
+      for (int x = clip.x0; x < clip.x1; x++) row[x] = c;
+    }
+  } else if (p.kind == DRAW_LINE) {  // Bresenham; y tek yönde ilerler
+    int x = p.x, y = p.y, dx = abs(p.w - p.x), dy = -abs(p.h - p.y);
+    int sx = p.x < p.w ? 1 : -1, sy = p.y < p.h ? 1 : -1, err = dx + dy;
+    while (true) {
+      if (sy > 0 ? y >= by1 : y < by) break;
+      rasterPlot(buf, bx, by, bw, bh, x, y, c);
+      if (x == p.w && y == p.h) break;
+      int e2 = 2 * err;
+      if (e2 >= dy) { err += dy; x += sx; }
+      if (e2 <= dx) { err += dx; y += sy; }
+    }
+  } else {  // Orta nokta çember algoritması, 8 simetrik nokta; y artar, x azalır
+    int dyMin = (by <= p.y && p.y < by1) ? 0 : min(abs(by - p.y), abs(by1 - 1 - p.y));
+    int dyMax = max(abs(by - p.y), abs(by1 - 1 - p.y));
+    int x = p.w, y = 0, err = 1 - p.w;
+    while (x >= y && x >= dyMin && y <= dyMax) {
+      if (y >= dyMin) {
+        rasterPlot(buf, bx, by, bw, bh, p.x + x, p.y + y, c); rasterPlot(buf, bx, by, bw, bh, p.x - x, p.y + y, c);
+        rasterPlot(buf, bx, by, bw, bh, p.x + x, p.y - y, c); rasterPlot(buf, bx, by, bw, bh, p.x - x, p.y - y, c);
+      }
+      if (x <= dyMax) {
+        rasterPlot(buf, bx, by, bw, bh, p.x + y, p.y + x, c); rasterPlot(buf, bx, by, bw, bh, p.x - y, p.y + x, c);
+        rasterPlot(buf, bx, by, bw, bh, p.x + y, p.y - x, c); rasterPlot(buf, bx, by, bw, bh, p.x - y, p.y - x, c);
+      }
+      y++;
+      if (err < 0) err += 2 * y + 1;
+      else { x--; err += 2 * (y - x) + 1; }
+    }
+  }
+}
+
+// Her bölge: bölgeye değen şekiller bir kez seçilip kırpılır, pencere bir kez açılır, sonra şeritler sırayla
+// rasterize edilip piksel hedefine gönderilir.
+static void rasterFinishScene() {
+  uint32_t t0_us = micros();
+  uint16_t bg = (uint16_t)((DRAW_BG_COLOR >> 8) | (DRAW_BG_COLOR << 8));
+  for (int i = 0; i < rasterRegionCount; i++) {
+    const RasterRect& r = rasterRegions[i];
+    int clipCount = 0;
+    for (int k = 0; k < frameCount; k++) {
+      int x0, y0, x1, y1;
+      primBounds(framePrims[k], x0, y0, x1, y1);
+      x0 = max(x0, (int)r.x0); y0 = max(y0, (int)r.y0); x1 = min(x1, (int)r.x1); y1 = min(y1, (int)r.y1);
+      if (x1 <= x0 || y1 <= y0) continue;
+      RasterClip clip = { (int16_t)k, (int16_t)x0, (int16_t)y0, (int16_t)x1, (int16_t)y1 };
+      rasterClips[clipCount++] = clip;
+    }
+
+    int w = r.x1 - r.x0;
+    int lines = max(1, RASTER_BAND_PIXELS / w);
+    pixelSink->window(r.x0, r.y0, r.x1, r.y1);
+    for (int y = r.y0; y < r.y1; y += lines) {
+      int h = min(lines, r.y1 - y);
+      uint16_t* buf = pixelSink->band();
+      for (int n = 0; n < w * h; n++) buf[n] = bg;
+      for (int k = 0; k < clipCount; k++) {
+        const RasterClip& clip = rasterClips[k];
+        if (clip.y1 <= y || y + h <= clip.y0) continue;
+        rasterPrim(framePrims[clip.prim], clip, buf, r.x0, y, w, h);
+      }
+      pixelSink->push(buf, w * h);
+    }
+    rasterStats.pixels += (uint32_t)w * (r.y1 - r.y0);
+  }
+  rasterStats.regions += rasterRegionCount;
+  rasterRegionCount = 0;
+  uint32_t took_us = micros() - t0_us;
+  if (took_us > rasterStats.flushMax_us) rasterStats.flushMax_us = took_us;
+}
+
+const SceneBackend RASTER_BACKEND = { NULL, rasterClearScene, rasterAddRegion, rasterDrawPrim, rasterFinishScene, true };
+
+SceneRenderer sceneRenderer() {
+  if (displayOptions & DISPLAY_OPT_TFT)  return RENDERER_TFT;
+  if (displayOptions & DISPLAY_OPT_DRAW) return RENDERER_DRAW;
+  return RENDERER_COMPONENTS;
+}
+
+// Önceki kareyle fark: ekranda olup artık istenmeyen şekillerin kutuları silinir, yeni şekiller ve silinen
+// kutulara değen şekiller (sırayla: şerit, yaylar, koridor, araç, marker'lar) yeniden çizilir. Silinecek
+// alan ekranın yarısını aşarsa ya da ekran içeriği bilinmiyorsa tek temizlikle tam çizim daha ucuzdur.
+void flushDrawFrame() {
+  const SceneBackend& backend = (sceneRenderer() == RENDERER_TFT) ? RASTER_BACKEND : NEXTION_BACKEND;
+  int dirty[DRAW_PRIM_MAX][4];
+  int dirtyCount = 0;
+  uint32_t dirtyArea = 0;
+  for (int o = 0; o < drawnCount; o++) {
+    bool kept = false;
+    for (int n = 0; n < frameCount && !kept; n++) kept = samePrim(drawnPrims[o], framePrims[n]);
+    if (kept) continue;
+    int* r = dirty[dirtyCount++];
+    primBounds(drawnPrims[o], r[0], r[1], r[2], r[3]);
+    dirtyArea += (uint32_t)(r[2] - r[0]) * (r[3] - r[1]);
+  }
+
+  bool alarm = false;  // Kırmızı dolgu (alarm şeridi/marker'ı) olan kare
+  for (int n = 0; n < frameCount; n++) {
+    if (framePrims[n].kind == DRAW_FILL && framePrims[n].color == COLOR_RED) alarm = true;
+  }
+  if (backend.begin) backend.begin(alarm);
+
+  bool full = drawFullPending || dirtyArea > (uint32_t)SCREEN_WIDTH_PX * SCREEN_HEIGHT_PX / 2;
+  if (full) {
+    backend.clear();
+    if (!backend.regionBased) renderStats.drawPixels += (uint32_t)SCREEN_WIDTH_PX * SCREEN_HEIGHT_PX;
+    renderStats.drawFullRedraws++;
+    drawFullPending = false;
+  } else {
+    for (int d = 0; d < dirtyCount; d++) {
+      int* r = dirty[d];
+      if (r[2] <= r[0] || r[3] <= r[1]) continue;
+      backend.erase(r[0], r[1], r[2], r[3]);
+      if (!backend.regionBased) renderStats.drawPixels += (uint32_t)(r[2] - r[0]) * (r[3] - r[1]);
+    }
+  }
+
+  for (int n = 0; n < frameCount && !full; n++) {
+    bool known = false;  // Ekranda aynısı var
+    for (int o = 0; o < drawnCount && !known; o++) known = samePrim(framePrims[n], drawnPrims[o]);
+    bool redraw = !known;
+    if (known && !backend.regionBased) {
+      int x0, y0, x1, y1;
+      primBounds(framePrims[n], x0, y0, x1, y1);
+      for (int d = 0; d < dirtyCount && !redraw; d++) {
+        redraw = x0 < dirty[d][2] && dirty[d][0] < x1 && y0 < dirty[d][3] && dirty[d][1] < y1;
+      }
+    }
+    if (redraw) backend.draw(framePrims[n]);
+  }
+  if (full && !backend.regionBased) {
+    for (int n = 0; n < frameCount; n++) backend.draw(framePrims[n]);
+  }
+  if (backend.finish) backend.finish();
+
+  memcpy(drawnPrims, framePrims, sizeof(DrawPrim) * frameCount);
+  drawnCount = frameCount;
+}
@@ -0,0 +1,597 @@
+// Hedef deposu (SoA) ve CAN girişi, toplu çekirdekler (decode, ego-hareket, koridor, bölge),
+// poligon alarm bölgeleri, sabit karmaşa maskesi, doluluk ızgarası ve AoS karşılaştırma tabanı.
+#include "radar.h"
+
+// -------------------------------------------------------------------------------------------------
+// HEDEF DURUMU
+// -------------------------------------------------------------------------------------------------
+TargetStore   targets;
+uint32_t      scanSlotsSeen[RADAR_SLOT_COUNT / 32];
+
+// Kavisli koridor ve ego-hareket
+PathModel     pathModel          = { false, 0, 0, 0 };
+int16_t       steeringAngle_ddeg = 0;
+unsigned long steeringSeen_ms    = 0;
+int16_t       egoSpeed_cms       = 0;
+int16_t       egoYaw_mrads       = 0;
+unsigned long speedSeen_ms       = 0;
+bool          egoValid           = false;
+int16_t       zoneSpeedMargin_cm = 0;
+
+// Araç ızgarası katmanları: poligon bölgeler, karmaşa maskesi, doluluk
+PolyZone      polyZones[POLY_ZONE_MAX];
+uint8_t       zoneGrid[GRID_CELLS / 4];
+bool          polyZonesActive      = false;
+uint8_t       clutterMask[GRID_CELLS / 8];
+uint8_t       clutterHits[GRID_CELLS];
+bool          clutterLearning      = false;
+uint8_t       clutterSamples       = 0;
+uint8_t       clutterSamplesTarget = 0;
+unsigned long clutterNextSample_ms = 0;
+uint32_t      clutterRejected      = 0;
+uint8_t       occupancy[GRID_CELLS];
+unsigned long occNextDecay_ms      = 0;
+
+// -------------------------------------------------------------------------------------------------
+// HEDEF DEPOSU VE TOPLU ÇEKİRDEKLER
+// -------------------------------------------------------------------------------------------------
+// Çerçeve yolu: istatistik, heartbeat ve ham baytların depoya kopyalanması. Hesap yok.
+void ingestCanFrame(const twai_message_t& msg, unsigned long now) {
+  if (msg.identifier < RADAR_ID_FIRST || msg.identifier > RADAR_ID_LAST) {
+    if      (steerCanId != 0 && msg.identifier == steerCanId) ingestSteeringFrame(msg, now);
+    else if (speedCanId != 0 && msg.identifier == speedCanId) ingestSpeedFrame(msg, now);
+    else canFramesOther++;
+    return;
+  }
+
+  int  slot  = msg.identifier - RADAR_ID_FIRST;
+  bool valid = !(msg.data[7] & 0b00000001);
+  updateSlotStats(slot, valid, now);
+  markSensorAlive(slot / RADAR_OBJECTS_PER_SENSOR, now);
+
+  if (!valid) {
+    targets.flags[slot] = 0; // Sensör nesneyi düşürdü
+    return;
+  }
+
+  // Öğrenilmiş sabit karmaşa: takip ve çizimden önce, ham baytlardan tek bit okuma
+  if ((clutterOptions & CLUTTER_OPT_ENABLE) && !clutterLearning) {
+    int cell = gridCellFromRaw(msg.data[2], msg.data[3]);
+    if (cell >= 0 && clutterMaskedAt(cell)) {
+      targets.flags[slot] = 0;
+      clutterRejected++;
+      return;
+    }
+  }
+
+  CAN_PRINTF("[CAN] 0x%03X: %02X %02X %02X %02X\n", msg.identifier, msg.data[0], msg.data[1], msg.data[2], msg.data[3]);
+  targets.rawRange[slot] = msg.data[0];
+  targets.rawAngle[slot] = msg.data[1];
+  targets.rawX[slot]     = msg.data[2];
+  targets.rawY[slot]     = msg.data[3];
+  targets.seen_ms[slot]  = now;
+  targets.flags[slot]   |= TGT_ACTIVE | TGT_FRESH;
+}
+
+// Tarama sınırı: sensör nesnelerini taramada bir kez gönderir; son örnekten beri görülmüş bir slotun
+// yeni çerçevesi yeni taramanın başıdır. Birden çok sensörde örnek aralığı en hızlı sensörün taramasıdır.
+bool startsNewScan(const twai_message_t& msg) {
+  if (msg.identifier < RADAR_ID_FIRST || msg.identifier > RADAR_ID_LAST) return false;
+  int      slot   = msg.identifier - RADAR_ID_FIRST;
+  uint32_t bit    = 1UL << (slot & 31);
+  bool     repeat = scanSlotsSeen[slot >> 5] & bit;
+  if (repeat) memset(scanSlotsSeen, 0, sizeof(scanSlotsSeen));
+  scanSlotsSeen[slot >> 5] |= bit;
+  return repeat;
+}
+
+void runTargetKernels() {
+  decodeTargets();
+  compensateEgoMotion();
+  testCorridor();
+  classifyZones();
+}
+
+void expireTargets(unsigned long now) {
+  for (int i = 0; i < RADAR_SLOT_COUNT; i++) {
+    if ((targets.flags[i] & TGT_ACTIVE) && now - targets.seen_ms[i] > TARGET_HOLD_MS) {
+      targets.flags[i] = 0;
+    }
+  }
+}
+
+// Ham bayt (0.25 m) -> cm. Hız, ardışık iki çerçevenin farkından kayan ortalama ile.
+void decodeTargets() {
+  for (int i = 0; i < RADAR_SLOT_COUNT; i++) {
+    uint8_t f = targets.flags[i];
+    if (!(f & TGT_FRESH)) continue;
+
+    int16_t x_cm = targets.rawX[i] * 25;
+    int16_t y_cm = ((int16_t)targets.rawY[i] - 128) * 25;
+    if (i == predSlot) scorePrediction(i, x_cm, y_cm);
+
+    if (f & TGT_TRACKED) {
+      int32_t dt_ms = (int32_t)(targets.seen_ms[i] - targets.decoded_ms[i]);
+      if (dt_ms > 0) {
+        int32_t vx = (int32_t)(x_cm - targets.x_cm[i]) * 1000 / dt_ms;
+        int32_t vy = (int32_t)(y_cm - targets.y_cm[i]) * 1000 / dt_ms;
+        targets.vx_cms[i] += (vx - targets.vx_cms[i]) / 4;
+        targets.vy_cms[i] += (vy - targets.vy_cms[i]) / 4;
+      }
+    } else {
+      targets.vx_cms[i] = 0;
+      targets.vy_cms[i] = 0;
+    }
+
+    targets.r_cm[i]       = targets.rawRange[i] * 25;
+    targets.angle_deg[i]  = (int)targets.rawAngle[i] - 128;
+    targets.x_cm[i]       = x_cm;
+    targets.y_cm[i]       = y_cm;
+    targets.decoded_ms[i] = targets.seen_ms[i];
+    targets.cell[i]       = gridCellFromRaw(targets.rawX[i], targets.rawY[i]);
+    if (targets.cell[i] >= 0) occupancyHit(targets.cell[i]);
+    targets.flags[i]      = (f & ~TGT_FRESH) | TGT_TRACKED;
+  }
+}
+
+// Düz koridor: |yanal| < araç genişliği / 2 + yan boşluk
+// Kavisli koridor: ileri yarı düzlemde, dönme merkezine uzaklığın karesi halka içinde mi
+void testCorridor() {
+  unsigned long sourceSeen_ms = steerCanId ? steeringSeen_ms : speedSeen_ms;
+  bool curved = pathModel.curved && (millis() - sourceSeen_ms) <= STEER_TIMEOUT_MS;
+
+  if (!curved) {
+    for (int i = 0; i < RADAR_SLOT_COUNT; i++) {
+      bool inside = abs(targets.y_cm[i]) < halfCorridor_cm;
+      targets.flags[i] = (targets.flags[i] & ~TGT_IN_CORRIDOR) | (inside ? TGT_IN_CORRIDOR : 0);
+    }
+    return;
+  }
+
+  const int32_t cy = pathModel.centerY_cm, inner = pathModel.innerSq_cm2, outer = pathModel.outerSq_cm2;
+  for (int i = 0; i < RADAR_SLOT_COUNT; i++) {
+    int32_t x  = targets.x_cm[i];
+    int32_t dy = targets.y_cm[i] - cy;
+    int32_t d2 = x * x + dy * dy;
+    bool inside = (x >= 0) && (d2 > inner) && (d2 < outer);
+    targets.flags[i] = (targets.flags[i] & ~TGT_IN_CORRIDOR) | (inside ? TGT_IN_CORRIDOR : 0);
+  }
+}
+
+void ingestSteeringFrame(const twai_message_t& msg, unsigned long now) {
+  int16_t raw = (int16_t)(msg.data[STEER_ANGLE_BYTE] | (msg.data[STEER_ANGLE_BYTE + 1] << 8));
+  steeringSeen_ms = now;
+  if (raw == steeringAngle_ddeg) return;
+  steeringAngle_ddeg = raw;
+  updatePathModel();
+}
+
+void ingestSpeedFrame(const twai_message_t& msg, unsigned long now) {
+  int16_t rawSpeed = (int16_t)(msg.data[SPEED_BYTE] | (msg.data[SPEED_BYTE + 1] << 8));
+  int16_t rawYaw   = (int16_t)(msg.data[YAW_BYTE]   | (msg.data[YAW_BYTE + 1] << 8));
+
+  egoSpeed_cms = (int16_t)((int32_t)rawSpeed * 5 / 18);                       // 0.01 km/h -> cm/s
+  egoYaw_mrads = (speedOptions & SPEED_OPT_YAW) ? (int16_t)((int32_t)rawYaw * 1745 / 10000) : 0; // 0.01 derece/s -> mrad/s
+  speedSeen_ms = now;
+
+  if (steerCanId == 0 && (speedOptions & SPEED_OPT_YAW)) updatePathModel();
+}
+
+// Ölçülen (göreli) hız + ego hareket = zemine göre hız. Sabit nesne için göreli hız
+// -v + w*y (ileri) ve -w*x (yanal) olduğundan: zemin = göreli + v - w*y, göreli + w*x.
+void compensateEgoMotion() {
+  egoValid = (speedCanId != 0) && (millis() - speedSeen_ms) <= SPEED_TIMEOUT_MS;
+
+  int32_t v = egoValid ? egoSpeed_cms : 0;
+  int32_t w = egoValid ? egoYaw_mrads : 0;
+
+  // Yaklaşırken bölge eşikleri hız x önden bakış süresi kadar genişler
+  int32_t margin = v > 0 ? v * ZONE_SPEED_LOOKAHEAD_MS / 1000 : 0;
+  zoneSpeedMargin_cm = margin > ZONE_SPEED_MARGIN_MAX_CM ? ZONE_SPEED_MARGIN_MAX_CM : margin;
+
+  for (int i = 0; i < RADAR_SLOT_COUNT; i++) {
+    int32_t gvx = targets.vx_cms[i] + v - w * targets.y_cm[i] / 1000;
+    int32_t gvy = targets.vy_cms[i] + w * targets.x_cm[i] / 1000;
+    targets.groundVx_cms[i] = (int16_t)gvx;
+    targets.groundVy_cms[i] = (int16_t)gvy;
+
+    bool isStatic = (targets.flags[i] & TGT_TRACKED) && (abs(gvx) + abs(gvy) < STATIC_TARGET_CMS);
+    targets.flags[i] = (targets.flags[i] & ~TGT_STATIC) | (isStatic ? TGT_STATIC : 0);
+  }
+}
+
+// Direksiyon, yaw veya araç ayarı değiştiğinde (hedef başına değil).
+// Direksiyon: R = aks mesafesi / tan(açı). Direksiyon yoksa yaw: R = hız / yaw rate.
+void updatePathModel() {
+  float radius;
+  if (steerCanId != 0) {
+    int angle_ddeg = STEER_SIGN * steeringAngle_ddeg;
+    if (abs(angle_ddeg) < STEER_DEADBAND_DDEG) {
+      pathModel.curved = false;
+      return;
+    }
+    radius = wheelbase_cm / tanf(angle_ddeg * (float)M_PI / 1800.0f);
+  } else if (speedCanId != 0 && (speedOptions & SPEED_OPT_YAW)) {
+    if (abs(egoYaw_mrads) < YAW_DEADBAND_MRADS || abs(egoSpeed_cms) < YAW_MIN_SPEED_CMS) {
+      pathModel.curved = false;
+      return;
+    }
+    radius = egoSpeed_cms * 1000.0f / egoYaw_mrads;
+  } else {
+    pathModel.curved = false;
+    return;
+  }
+
+  if (fabsf(radius) > STEER_MAX_RADIUS_CM) {
+    pathModel.curved = false;
+    return;
+  }
+
+  int32_t r     = (int32_t)lroundf(radius);
+  int32_t rAbs  = abs(r);
+  int32_t inner = rAbs - halfCorridor_cm;
+  int32_t outer = rAbs + halfCorridor_cm;
+  if (inner < 0) inner = 0;
+
+  pathModel.centerY_cm  = r;
+  pathModel.innerSq_cm2 = inner * inner;
+  pathModel.outerSq_cm2 = outer * outer;
+  pathModel.curved      = true;
+}
+
+// AutoZoom açıkken sabit kademeler (5 / 3 / 1.5 m), kapalıyken kullanıcı bölgeleri.
+// Poligon bölgesi tanımlıysa bölge ve koridor, ızgara tablosundan tek okumayla belirlenir.
+void classifyZones() {
+  if (polyZonesActive) {
+    for (int i = 0; i < RADAR_SLOT_COUNT; i++) {
+      int c = targets.cell[i];
+      uint8_t zone = c >= 0 ? zoneLevelAt(c) : (uint8_t)ZONE_SAFE;
+      targets.zone[i]  = zone;
+      targets.flags[i] = (targets.flags[i] & ~TGT_IN_CORRIDOR) | (zone != ZONE_SAFE ? TGT_IN_CORRIDOR : 0);
+    }
+    return;
+  }
+
+  for (int i = 0; i < RADAR_SLOT_COUNT; i++) {
+    int16_t r_cm = targets.r_cm[i] - zoneSpeedMargin_cm; // Hıza göre genişleyen bölgeler
+    uint8_t zone;
+    if (autoZoom_enabled) {
+      if      (r_cm > AUTOZOOM_SAFE_CM)    zone = ZONE_SAFE;
+      else if (r_cm > AUTOZOOM_WARNING_CM) zone = ZONE_WARNING;
+      else if (r_cm > AUTOZOOM_DANGER_CM)  zone = ZONE_DANGER;
+      else                                 zone = ZONE_ALARM;
+    } else {
+      if      (r_cm > warningZone_cm) zone = ZONE_SAFE;
+      else if (r_cm > dangerZone_cm)  zone = ZONE_WARNING;
+      else                            zone = ZONE_ALARM;
+    }
+    targets.zone[i] = zone;
+  }
+}
+
+int findNearestTarget() {
+  int nearest = -1;
+  for (int i = 0; i < RADAR_SLOT_COUNT; i++) {
+    if (!(targets.flags[i] & TGT_ACTIVE)) continue;
+    if (nearest < 0 || targets.r_cm[i] < targets.r_cm[nearest]) nearest = i;
+  }
+  return nearest;
+}
+
+// Buzzer, koridordaki ve uyarı bölgesindeki en yüksek seviyeli (eşitse en yakın) hedefe göre çalar.
+// Poligon modunda koridor = herhangi bir alarm poligonunun içi, mesafe kapısı yok.
+// Araç dururken zemine göre sabit nesneler (sabit karmaşa) alarm vermez.
+void updateBuzzerFromTargets() {
+  bool egoStopped = egoValid && abs(egoSpeed_cms) < EGO_STOPPED_CMS;
+  int closest = -1;
+  alarmTarget = -1;
+  for (int i = 0; i < RADAR_SLOT_COUNT; i++) {
+    uint8_t f = targets.flags[i];
+    if (!(f & TGT_ACTIVE) || !(f & TGT_IN_CORRIDOR)) continue;
+    if (egoStopped && (f & TGT_STATIC)) continue;
+    if (!polyZonesActive && targets.r_cm[i] >= warningZone_cm + zoneSpeedMargin_cm) continue;
+    if ((occOptions & OCC_OPT_CONFIRM) && targets.cell[i] >= 0 && occupancy[targets.cell[i]] < OCC_CONFIRM) continue;
+    if (closest < 0 || targets.zone[i] > targets.zone[closest] ||
+        (targets.zone[i] == targets.zone[closest] && targets.r_cm[i] < targets.r_cm[closest])) closest = i;
+  }
+
+  alarmTarget = closest;
+  if (!audioAlarm_enabled || closest < 0) {
+    buzzerShouldBeActive = false;
+    return;
+  }
+
+  buzzerShouldBeActive = true;
+  uint8_t zone = targets.zone[closest];
+  if (targets.r_cm[closest] <= SOLID_TONE_DISTANCE_CM) currentBeepInterval = 0;
+  else if (zone == ZONE_ALARM)                        currentBeepInterval = BEEP_INTERVAL_RED_MS;
+  else if (zone == ZONE_DANGER)                       currentBeepInterval = BEEP_INTERVAL_ORANGE_MS;
+  else                                                currentBeepInterval = BEEP_INTERVAL_YELLOW_MS;
+}
+
+// -------------------------------------------------------------------------------------------------
+// POLİGON ALARM BÖLGELERİ
+// -------------------------------------------------------------------------------------------------
+// Her ızgara satırı için kenar kesişimleri (kenar tablosu) sıralanır, çiftler arası doldurulur.
+// Çakışan poligonlarda hücre en yüksek seviyeyi alır. Sadece düzenlemede çalışır.
+void rebuildZoneGrid() {
+  memset(zoneGrid, 0, sizeof(zoneGrid));
+  polyZonesActive = false;
+
+  for (int z = 0; z < POLY_ZONE_MAX; z++) {
+    const PolyZone& pz = polyZones[z];
+    if (pz.count < 3 || pz.level == ZONE_SAFE) continue;
+    polyZonesActive = true;
+
+    for (int cy = 0; cy < GRID_Y_CELLS; cy++) {
+      int32_t y = (int32_t)(cy - GRID_Y_CELLS / 2) * GRID_CELL_CM;
+      int32_t xs[POLY_VERTEX_MAX];
+      int n = 0;
+
+      for (int e = 0; e < pz.count; e++) {
+        int32_t x1 = pz.x_cm[e], y1 = pz.y_cm[e];
+        int32_t x2 = pz.x_cm[(e + 1) % pz.count], y2 = pz.y_cm[(e + 1) % pz.count];
+        if ((y1 <= y && y < y2) || (y2 <= y && y < y1)) {
+          xs[n++] = x1 + (y - y1) * (x2 - x1) / (y2 - y1);
+        }
+      }
+
+      for (int a = 1; a < n; a++) {
+        int32_t v = xs[a];
+        int b = a - 1;
+        while (b >= 0 && xs[b] > v) { xs[b + 1] = xs[b]; b--; }
+        xs[b + 1] = v;
+      }
+
+      for (int k = 0; k + 1 < n; k += 2) {
+        if (xs[k + 1] < 0) continue;
+        int cxStart = xs[k] <= 0 ? 0 : (xs[k] + GRID_CELL_CM - 1) / GRID_CELL_CM;
+        int cxEnd   = xs[k + 1] / GRID_CELL_CM;
+        if (cxEnd >= GRID_X_CELLS) cxEnd = GRID_X_CELLS - 1;
+
+        for (int cx = cxStart; cx <= cxEnd; cx++) {
+          int cell = cy * GRID_X_CELLS + cx;
+          if (zoneLevelAt(cell) >= pz.level) continue;
+          int shift = (cell & 3) * 2;
+          zoneGrid[cell >> 2] = (zoneGrid[cell >> 2] & ~(0x03 << shift)) | (pz.level << shift);
+        }
+      }
+    }
+  }
+}
+
+// -------------------------------------------------------------------------------------------------
+// SABİT KARMAŞA ÖĞRENME
+// -------------------------------------------------------------------------------------------------
+void startClutterLearning(int seconds) {
+  memset(clutterHits, 0, sizeof(clutterHits));
+  clutterSamples       = 0;
+  clutterSamplesTarget = seconds * 1000 / CLUTTER_SAMPLE_MS;
+  clutterNextSample_ms = millis();
+  clutterLearning      = true;
+  Serial.printf("[CLUTTER] Ogrenme basladi: %d s, arac ve cevre sabit kalmali.\n", seconds);
+}
+
+// Sabit örnekleme: tutma süresi (TARGET_HOLD_MS) sayesinde sürekli görülen nesne her örnekte aktiftir.
+void learnClutter(unsigned long now) {
+  if ((long)(now - clutterNextSample_ms) < 0) return;
+  clutterNextSample_ms += CLUTTER_SAMPLE_MS;
+
+  for (int i = 0; i < RADAR_SLOT_COUNT; i++) {
+    if (!(targets.flags[i] & TGT_ACTIVE)) continue;
+    int cell = gridCellFromRaw(targets.rawX[i], targets.rawY[i]);
+    if (cell >= 0 && clutterHits[cell] <= clutterSamples) clutterHits[cell]++; // Aynı hücrede iki hedef tek sayılır
+  }
+  if (++clutterSamples >= clutterSamplesTarget) finishClutterLearning();
+}
+
+void finishClutterLearning() {
+  clutterLearning = false;
+  memset(clutterMask, 0, sizeof(clutterMask));
+
+  for (int cy = 0; cy < GRID_Y_CELLS; cy++) {
+    for (int cx = 0; cx < GRID_X_CELLS; cx++) {
+      if (clutterHits[cy * GRID_X_CELLS + cx] * 100 < clutterSamples * CLUTTER_LEARN_PERCENT) continue;
+      for (int dy = -CLUTTER_DILATE_CELLS; dy <= CLUTTER_DILATE_CELLS; dy++) {
+        for (int dx = -CLUTTER_DILATE_CELLS; dx <= CLUTTER_DILATE_CELLS; dx++) {
+          int nx = cx + dx, ny = cy + dy;
+          if (nx < 0 || nx >= GRID_X_CELLS || ny < 0 || ny >= GRID_Y_CELLS) continue;
+          int cell = ny * GRID_X_CELLS + nx;
+          clutterMask[cell >> 3] |= 1 << (cell & 7);
+        }
+      }
+    }
+  }
+
+  clutterOptions |= CLUTTER_OPT_ENABLE;
+  saveSettingsToEEPROM();
+  Serial.printf("[CLUTTER] Ogrenme bitti: %u ornek, %d hucre maskelendi.\n", clutterSamples, countClutterCells());
+}
+
+int countClutterCells() {
+  int n = 0;
+  for (int cell = 0; cell < GRID_CELLS; cell++) n += clutterMaskedAt(cell);
+  return n;
+}
+
+// -------------------------------------------------------------------------------------------------
+// DOLULUK IZGARASI
+// -------------------------------------------------------------------------------------------------
+// İsabetler decodeTargets() içinde eklenir; sönüm döngü hızından bağımsız sabit periyotla.
+void decayOccupancy(unsigned long now) {
+  if ((long)(now - occNextDecay_ms) < 0) return;
+  occNextDecay_ms = now + OCC_DECAY_MS;
+  for (int cell = 0; cell < GRID_CELLS; cell++) {
+    occupancy[cell] = (occupancy[cell] * 7) >> 3;
+  }
+}
+
+// Konsol için kaba harita: satır = yanal (sol üstte), sütun = ileri
+void dumpOccupancyMap() {
+  static const char shades[] = " .:-=+*#%@";
+  int active = 0;
+  Serial.println("\n[OCC] Doluluk haritasi (satir: y -8..+7.75 m, sutun: x 0..15.75 m)");
+  for (int cy = GRID_Y_CELLS - 1; cy >= 0; cy--) {
+    char line[GRID_X_CELLS + 1];
+    for (int cx = 0; cx < GRID_X_CELLS; cx++) {
+      uint8_t v = occupancy[cy * GRID_X_CELLS + cx];
+      if (v) active++;
+      line[cx] = shades[v * 9 / 255];
+    }
+    line[GRID_X_CELLS] = '\0';
+    Serial.println(line);
+  }
+  Serial.printf("Dolu hucre: %d, katman: %s, onay: %s\n", active,
+                (occOptions & OCC_OPT_OVERLAY) ? "acik" : "kapali", (occOptions & OCC_OPT_CONFIRM) ? "acik" : "kapali");
+}
+
+void dumpPolyZones() {
+  Serial.printf("\n[ZONE] Poligon modu: %s\n", polyZonesActive ? "Acik" : "Kapali (yaricap + koridor)");
+  for (int z = 0; z < POLY_ZONE_MAX; z++) {
+    const PolyZone& pz = polyZones[z];
+    if (pz.count == 0 && pz.level == ZONE_SAFE) continue;
+    Serial.printf("Bolge %d: seviye %d, %d kose%s:", z, pz.level, pz.count, pz.count < 3 ? " (etkin degil)" : "");
+    for (int v = 0; v < pz.count; v++) Serial.printf(" %d,%d", pz.x_cm[v], pz.y_cm[v]);
+    Serial.println();
+  }
+}
+
+void dumpTargets() {
+  unsigned long now = millis();
+  Serial.println("\n[TARGETS] Slot | ID | R | X | Y | Vx | Vy | Zemin Vx | Zemin Vy | Bolge | Koridor | Sabit | Yas");
+  for (int i = 0; i < RADAR_SLOT_COUNT; i++) {
+    if (!(targets.flags[i] & TGT_ACTIVE)) continue;
+    Serial.printf("%3d 0x%03X %dcm %dcm %dcm %dcm/s %dcm/s %dcm/s %dcm/s %d %d %d %lums\n",
+                  i, RADAR_ID_FIRST + i, targets.r_cm[i], targets.x_cm[i], targets.y_cm[i],
+                  targets.vx_cms[i], targets.vy_cms[i], targets.groundVx_cms[i], targets.groundVy_cms[i],
+                  targets.zone[i], (targets.flags[i] & TGT_IN_CORRIDOR) ? 1 : 0,
+                  (targets.flags[i] & TGT_STATIC) ? 1 : 0, now - targets.seen_ms[i]);
+  }
+}
+
+// AoS karşılaştırma tabanı (TargetRecord): sadece BENCH ve masaüstü testi kullanır.
+void copyTargetsToRecords(TargetRecord* t) {
+  for (int i = 0; i < RADAR_SLOT_COUNT; i++) {
+    t[i].rawRange = targets.rawRange[i];   t[i].rawAngle = targets.rawAngle[i];
+    t[i].rawX = targets.rawX[i];           t[i].rawY = targets.rawY[i];
+    t[i].r_cm = targets.r_cm[i];           t[i].x_cm = targets.x_cm[i];
+    t[i].y_cm = targets.y_cm[i];           t[i].angle_deg = targets.angle_deg[i];
+    t[i].vx_cms = targets.vx_cms[i];       t[i].vy_cms = targets.vy_cms[i];
+    t[i].groundVx_cms = targets.groundVx_cms[i];
+    t[i].groundVy_cms = targets.groundVy_cms[i];
+    t[i].zone = targets.zone[i];           t[i].flags = targets.flags[i];
+    t[i].seen_ms = targets.seen_ms[i];     t[i].decoded_ms = targets.decoded_ms[i];
+    t[i].cell = targets.cell[i];
+  }
+}
+
+void testCorridorRecords(TargetRecord* t, bool curved) {
+  const int32_t cy = pathModel.centerY_cm, inner = pathModel.innerSq_cm2, outer = pathModel.outerSq_cm2;
+  for (int i = 0; i < RADAR_SLOT_COUNT; i++) {
+    bool inside;
+    if (curved) {
+      int32_t x  = t[i].x_cm;
+      int32_t dy = t[i].y_cm - cy;
+      int32_t d2 = x * x + dy * dy;
+      inside = (x >= 0) && (d2 > inner) && (d2 < outer);
+    } else {
+      inside = abs(t[i].y_cm) < halfCorridor_cm;
+    }
+    t[i].flags = (t[i].flags & ~TGT_IN_CORRIDOR) | (inside ? TGT_IN_CORRIDOR : 0);
+  }
+}
+
+void classifyZonesRecords(TargetRecord* t) {
+  for (int i = 0; i < RADAR_SLOT_COUNT; i++) {
+    uint8_t zone;
+    if (polyZonesActive) {
+      zone = t[i].cell >= 0 ? zoneLevelAt(t[i].cell) : (uint8_t)ZONE_SAFE;
+      t[i].flags = (t[i].flags & ~TGT_IN_CORRIDOR) | (zone != ZONE_SAFE ? TGT_IN_CORRIDOR : 0);
+    } else {
+      int16_t r_cm = t[i].r_cm - zoneSpeedMargin_cm;
+      if (autoZoom_enabled) {
+        if      (r_cm > AUTOZOOM_SAFE_CM)    zone = ZONE_SAFE;
+        else if (r_cm > AUTOZOOM_WARNING_CM) zone = ZONE_WARNING;
+        else if (r_cm > AUTOZOOM_DANGER_CM)  zone = ZONE_DANGER;
+        else                                 zone = ZONE_ALARM;
+      } else {
+        if      (r_cm > warningZone_cm) zone = ZONE_SAFE;
+        else if (r_cm > dangerZone_cm)  zone = ZONE_WARNING;
+        else                            zone = ZONE_ALARM;
+      }
+    }
+    t[i].zone = zone;
+  }
+}
+
+// SoA depo ile AoS kopyası arasında koridor bayrağı veya bölgesi farklı hedef sayısı
+int countRecordMismatches(const TargetRecord* t) {
+  int n = 0;
+  for (int i = 0; i < RADAR_SLOT_COUNT; i++) {
+    if (((targets.flags[i] ^ t[i].flags) & TGT_IN_CORRIDOR) || targets.zone[i] != t[i].zone) n++;
+  }
+  return n;
+}
+
+// Cihaz üstü ölçüm: 128 hedeflik tam dizi üzerinde çekirdek başına çevrim sayısı, SoA ve AoS
+void runKernelBenchmark() {
+  const int ROUNDS = 100;
+  bool savedCurved = pathModel.curved;
+  unsigned long savedSteer = steeringSeen_ms, savedSpeed = speedSeen_ms;
+  uint32_t t0, straight, curved, zones;
+  uint32_t aosStraight = 0, aosCurved = 0, aosZones = 0;
+  int mismatches = 0;
+
+  // AoS kopyası (~4.6 KB) sadece ölçüm süresince heap'te
+  TargetRecord* aos = (TargetRecord*)malloc(sizeof(TargetRecord) * RADAR_SLOT_COUNT);
+  if (aos) copyTargetsToRecords(aos);
+
+  pathModel.curved = false;
+  t0 = ESP.getCycleCount();
+  for (int r = 0; r < ROUNDS; r++) testCorridor();
+  straight = (ESP.getCycleCount() - t0) / ROUNDS;
+  if (aos) {
+    t0 = ESP.getCycleCount();
+    for (int r = 0; r < ROUNDS; r++) testCorridorRecords(aos, false);
+    aosStraight = (ESP.getCycleCount() - t0) / ROUNDS;
+    mismatches += countRecordMismatches(aos);
+  }
+
+  pathModel.curved = true;
+  steeringSeen_ms = speedSeen_ms = millis();  // testCorridor kaynağa göre birini okur; ikisi de taze
+  t0 = ESP.getCycleCount();
+  for (int r = 0; r < ROUNDS; r++) testCorridor();
+  curved = (ESP.getCycleCount() - t0) / ROUNDS;
+  if (aos) {
+    t0 = ESP.getCycleCount();
+    for (int r = 0; r < ROUNDS; r++) testCorridorRecords(aos, true);
+    aosCurved = (ESP.getCycleCount() - t0) / ROUNDS;
+    mismatches += countRecordMismatches(aos);
+  }
+
+  pathModel.curved = savedCurved;
+  steeringSeen_ms  = savedSteer;
+  speedSeen_ms     = savedSpeed;
+  testCorridor();
+
+  t0 = ESP.getCycleCount();
+  for (int r = 0; r < ROUNDS; r++) classifyZones();
+  zones = (ESP.getCycleCount() - t0) / ROUNDS;
+  if (aos) {
+    copyTargetsToRecords(aos);  // Geri yüklenen koridor bayrakları
+    t0 = ESP.getCycleCount();
+    for (int r = 0; r < ROUNDS; r++) classifyZonesRecords(aos);
+    aosZones = (ESP.getCycleCount() - t0) / ROUNDS;
+    mismatches += countRecordMismatches(aos);
+  }
+
+  Serial.printf("[BENCH] %d hedef, cevrim/parti: duz koridor %u, kavisli koridor %u, bolge %u\n",
+                RADAR_SLOT_COUNT, straight, curved, zones);
+  if (aos) {
+    Serial.printf("[BENCH] AoS taban: duz koridor %u, kavisli koridor %u, bolge %u (fark %d hedef)\n",
+                  aosStraight, aosCurved, aosZones, mismatches);
+    free(aos);
+  } else {
+    Serial.println("[BENCH] AoS taban icin bellek yok");
+  }
+}
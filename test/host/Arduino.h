@@ -0,0 +1,168 @@
+// Masaüstü (native) testler için Arduino/ESP32 yerine geçen asgari katman.
+// Test programı src/*.cpp ile birlikte derlenip bağlanır; ortak durum (saat, konsol, EEPROM, CAN kuyruğu)
+// şablon statik üyelerinde tutulur: C++11'de satır içi değişken yok, şablon üyesi tüm çeviri birimlerinde
+// tek nesnedir ve her birimdeki statik referans ona bağlanır.
+// Zaman (hostMillis) ve Nextion UART'ı (HardwareSerial::wire / drain) testten yönetilir.
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+using std::min;
+using std::max;
+
+#define HIGH 1
+#define LOW 0
+#define OUTPUT 1
+#define INPUT 0
+#define SERIAL_8N1 0x800001c
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define pdMS_TO_TICKS(x) (x)
+#define ESP_OK 0
+#define ESP_ERR_TIMEOUT 0x107
+typedef int esp_err_t;
+typedef uint32_t TickType_t;
+typedef bool boolean;
+typedef uint8_t byte;
+
+template <typename = void> struct HostClock {
+  static unsigned long ms;       // Testin ilerlettiği saat
+  static bool          verbose;  // Konsol çıktısı stdout'a
+};
+template <typename T> unsigned long HostClock<T>::ms      = 0;
+template <typename T> bool          HostClock<T>::verbose = false;
+static unsigned long& hostMillis  __attribute__((unused)) = HostClock<>::ms;
+static bool&          hostVerbose __attribute__((unused)) = HostClock<>::verbose;
+
+void setup();  // Program (src/main.cpp)
+void loop();
+
+inline unsigned long millis() { return hostMillis; }
+inline unsigned long micros() { return hostMillis * 1000UL; }
+inline void delay(unsigned long ms) { hostMillis += ms; }
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int  digitalRead(uint8_t) { return LOW; }
+
+class String {
+public:
+  String(const char* s = "") : s_(s ? s : "") {}
+  String(const std::string& s) : s_(s) {}
+  String(char c) : s_(1, c) {}
+  String(int v, unsigned char base = 10) : s_(format(base == 16 ? "%x" : "%d", v)) {}
+  String(unsigned int v, unsigned char base = 10) : s_(format(base == 16 ? "%x" : "%u", v)) {}
+  String(long v, unsigned char base = 10) : s_(format(base == 16 ? "%lx" : "%ld", v)) {}
+  String(unsigned long v, unsigned char base = 10) : s_(format(base == 16 ? "%lx" : "%lu", v)) {}
+  String(double v, unsigned int decimals = 2) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v);
+    s_ = buf;
+  }
+  String& operator+=(const String& o) { s_ += o.s_; return *this; }
+  friend String operator+(const String& a, const String& b) { return String(a.s_ + b.s_); }
+  friend String operator+(const String& a, const char* b) { return String(a.s_ + b); }
+  friend String operator+(const char* a, const String& b) { return String(a + b.s_); }
+  bool operator==(const char* o) const { return s_ == o; }
+  unsigned int length() const { return s_.size(); }
+  const char* c_str() const { return s_.c_str(); }
+private:
+  template <typename T> static std::string format(const char* fmt, T v) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), fmt, v);
+    return buf;
+  }
+  std::string s_;
+};
+
+// Her port yazılanları wire'da biriktirir; konsol (Serial) ayrıca stdout'a yazar (hostVerbose).
+// Nextion portunda gönderilmeyi bekleyen bayt (pending) drain() çağrılana kadar UART'ta durur.
+class HardwareSerial {
+public:
+  explicit HardwareSerial(int port) : port_(port) {}
+  void   begin(unsigned long, uint32_t = SERIAL_8N1, int8_t = -1, int8_t = -1) {}
+  size_t setTxBufferSize(size_t n) { txCapacity = n; return n; }
+  size_t write(uint8_t c) { return write(&c, 1); }
+  size_t write(const uint8_t* p, size_t n) {
+    wire.append((const char*)p, n);
+    if (port_ == 0) { if (hostVerbose) fwrite(p, 1, n, stdout); return n; }
+    pending += n;
+    if (autoDrain) pending = 0;
+    return n;
+  }
+  size_t write(const char* p, size_t n) { return write((const uint8_t*)p, n); }
+  size_t print(const char* s) { return write(s, strlen(s)); }
+  size_t print(const String& s) { return print(s.c_str()); }
+  size_t println(const char* s = "") { return print(s) + print("\n"); }
+  size_t println(const String& s) { return println(s.c_str()); }
+  size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+    char buf[512];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    return write(buf, min(n, (int)sizeof(buf) - 1));
+  }
+  int  available() { return (int)(rx.size() - rxPos); }
+  int  read() { return rxPos < rx.size() ? (uint8_t)rx[rxPos++] : -1; }
+  int  peek() { return rxPos < rx.size() ? (uint8_t)rx[rxPos] : -1; }
+  void setTimeout(unsigned long) {}
+  size_t readBytesUntil(char term, char* buf, size_t len) {
+    size_t n = 0;
+    while (n < len && rxPos < rx.size() && rx[rxPos] != term) buf[n++] = rx[rxPos++];
+    if (rxPos < rx.size() && rx[rxPos] == term) rxPos++;
+    return n;
+  }
+  int  availableForWrite() { return (int)(txCapacity + 128 - pending); }  // + donanım FIFO'su
+  void flush() { pending = 0; }
+
+  // Test tarafı
+  void drain(size_t n) { pending -= min(n, pending); }
+  void feed(const uint8_t* p, size_t n) { rx.append((const char*)p, n); }
+  void clearWire() { wire.clear(); }
+
+  std::string wire;
+  std::string rx;
+  size_t      rxPos      = 0;
+  size_t      pending    = 0;
+  size_t      txCapacity = 256;
+  bool        autoDrain  = true;
+
+private:
+  int port_;
+};
+
+template <typename = void> struct HostConsole { static HardwareSerial port; };
+template <typename T> HardwareSerial HostConsole<T>::port(0);
+static HardwareSerial& Serial __attribute__((unused)) = HostConsole<>::port;
+
+class EEPROMClass {
+public:
+  bool    begin(size_t) { return true; }
+  uint8_t read(int a) { return data[a]; }
+  void    write(int a, uint8_t v) { data[a] = v; }
+  template <typename T> T& get(int a, T& t) { memcpy(&t, data + a, sizeof(T)); return t; }
+  template <typename T> const T& put(int a, const T& t) { memcpy(data + a, &t, sizeof(T)); return t; }
+  bool    commit() { return true; }
+  uint8_t data[1024] = {};
+};
+template <typename = void> struct HostEeprom { static EEPROMClass chip; };
+template <typename T> EEPROMClass HostEeprom<T>::chip;
+static EEPROMClass& EEPROM __attribute__((unused)) = HostEeprom<>::chip;
+
+// 240 MHz çevrim sayacı (runKernelBenchmark/runFieldBenchmark masaüstünde de aynı birimi verir)
+class EspClass {
+public:
+  uint32_t getCycleCount() {
+    return (uint32_t)(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now().time_since_epoch()).count() * 240 / 1000);
+  }
+  uint32_t getFreeHeap() { return 0; }
+};
+static EspClass ESP __attribute__((unused));
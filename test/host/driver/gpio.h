@@ -0,0 +1,3 @@
+#pragma once
+#include "Arduino.h"
+typedef enum { GPIO_NUM_NC = -1, GPIO_NUM_4 = 4, GPIO_NUM_5 = 5 } gpio_num_t;
@@ -0,0 +1,90 @@
+// SPI sürücüsü yerine kayıt: DISPLAY_TFT=1 testlerinde TFT komutları (TXDATA'lı tek bayt) ve parametreleri
+// hostSpi'ye yazılır; kuyruğa alınan (DMA) aktarımlar tamamlanana kadar "uçuşta" sayılır. Tampon aktarım
+// sürerken değişirse (DMA okurken üzerine yazma) bozulma sayılır.
+#pragma once
+#include <vector>
+#include "Arduino.h"
+
+typedef enum { SPI1_HOST = 0, SPI2_HOST = 1, SPI3_HOST = 2 } spi_host_device_t;
+#define SPI_DMA_CH_AUTO      3
+#define SPI_TRANS_USE_TXDATA (1 << 3)
+#ifndef portMAX_DELAY
+  #define portMAX_DELAY 0xFFFFFFFFu
+#endif
+
+typedef struct { int mosi_io_num, miso_io_num, sclk_io_num, quadwp_io_num, quadhd_io_num, max_transfer_sz; } spi_bus_config_t;
+typedef struct { uint8_t mode; int clock_speed_hz; int spics_io_num; int queue_size; uint32_t flags; } spi_device_interface_config_t;
+typedef struct spi_device_t* spi_device_handle_t;
+typedef struct { uint32_t flags; size_t length; const void* tx_buffer; void* rx_buffer; uint8_t tx_data[4]; void* user; } spi_transaction_t;
+
+struct HostSpiCommand {
+  uint8_t              cmd;
+  std::vector<uint8_t> params;
+  uint32_t             pixelBytes;  // Komuttan sonra DMA ile giden veri (RAMWR)
+};
+
+struct HostSpiBus {
+  std::vector<HostSpiCommand>     commands;
+  std::vector<spi_transaction_t*> inFlight;
+  std::vector<uint32_t>           inFlightSum;
+  int      queueSize;
+  int      maxInFlight;
+  uint32_t overruns;   // Kuyruk boyutunu aşan aktarım
+  uint32_t corrupted;  // Aktarım sürerken değişen tampon
+};
+template <typename = void> struct HostSpiState { static HostSpiBus bus; };
+template <typename T> HostSpiBus HostSpiState<T>::bus;
+static HostSpiBus& hostSpi __attribute__((unused)) = HostSpiState<>::bus;
+
+inline uint32_t hostSpiChecksum(const spi_transaction_t* t) {
+  const uint8_t* p = (const uint8_t*)t->tx_buffer;
+  uint32_t h = 2166136261u;
+  for (size_t n = 0; n < t->length / 8; n++) { h ^= p[n]; h *= 16777619u; }
+  return h;
+}
+
+inline void hostSpiReset() {
+  hostSpi.commands.clear();
+  hostSpi.inFlight.clear();
+  hostSpi.inFlightSum.clear();
+  hostSpi.maxInFlight = 0;
+  hostSpi.overruns = hostSpi.corrupted = 0;
+}
+
+inline esp_err_t spi_bus_initialize(spi_host_device_t, const spi_bus_config_t*, int) { return ESP_OK; }
+inline esp_err_t spi_bus_add_device(spi_host_device_t, const spi_device_interface_config_t* dev, spi_device_handle_t* h) {
+  hostSpi.queueSize = dev->queue_size;
+  *h = (spi_device_handle_t)&hostSpi;
+  return ESP_OK;
+}
+
+inline esp_err_t spi_device_polling_transmit(spi_device_handle_t, spi_transaction_t* t) {
+  if (!hostSpi.inFlight.empty()) hostSpi.overruns++;  // Bloklayan gönderim DMA bitmeden başlamamalı
+  if (t->flags & SPI_TRANS_USE_TXDATA) {
+    HostSpiCommand c = { t->tx_data[0], std::vector<uint8_t>(), 0 };
+    hostSpi.commands.push_back(c);
+  } else if (!hostSpi.commands.empty()) {
+    const uint8_t* p = (const uint8_t*)t->tx_buffer;
+    hostSpi.commands.back().params.insert(hostSpi.commands.back().params.end(), p, p + t->length / 8);
+  }
+  return ESP_OK;
+}
+
+inline esp_err_t spi_device_queue_trans(spi_device_handle_t, spi_transaction_t* t, TickType_t) {
+  if ((int)hostSpi.inFlight.size() >= hostSpi.queueSize) hostSpi.overruns++;
+  hostSpi.inFlight.push_back(t);
+  hostSpi.inFlightSum.push_back(hostSpiChecksum(t));
+  hostSpi.maxInFlight = max(hostSpi.maxInFlight, (int)hostSpi.inFlight.size());
+  if (!hostSpi.commands.empty()) hostSpi.commands.back().pixelBytes += t->length / 8;
+  return ESP_OK;
+}
+
+// En eski aktarım biter
+inline esp_err_t spi_device_get_trans_result(spi_device_handle_t, spi_transaction_t** done, TickType_t) {
+  if (hostSpi.inFlight.empty()) return ESP_ERR_TIMEOUT;
+  *done = hostSpi.inFlight.front();
+  if (hostSpiChecksum(*done) != hostSpi.inFlightSum.front()) hostSpi.corrupted++;
+  hostSpi.inFlight.erase(hostSpi.inFlight.begin());
+  hostSpi.inFlightSum.erase(hostSpi.inFlightSum.begin());
+  return ESP_OK;
+}
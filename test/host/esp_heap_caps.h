@@ -0,0 +1,5 @@
+// DMA'ya uygun bellek yerine sıradan yığın (DISPLAY_TFT=1 testleri)
+#pragma once
+#include <stdlib.h>
+#define MALLOC_CAP_DMA (1 << 3)
+inline void* heap_caps_malloc(size_t size, uint32_t) { return malloc(size); }
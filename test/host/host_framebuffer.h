@@ -0,0 +1,54 @@
+// Masaüstü piksel hedefi: RENDER TFT çıkışı SPI yerine RGB565 çerçeve tamponuna yazılır, PPM olarak
+// kaydedilebilir. radar.h'den sonra içerilir (PixelSink, RASTER_BAND_PIXELS, SCREEN_*).
+#pragma once
+#include <stdio.h>
+
+struct HostFramebuffer {
+  uint16_t pixels[SCREEN_WIDTH_PX * SCREEN_HEIGHT_PX];  // RGB565, ana bilgisayar bayt sırası
+  uint16_t band[RASTER_BAND_PIXELS];
+  int      x0, x1, x, y;       // Açık pencere ve yazma konumu (TFT RAMWR gibi satır satır)
+  uint32_t pushedPixels;
+  uint32_t pushedBytes;        // SPI'da gidecek bayt (piksel başına 2)
+  uint32_t windows;
+  uint32_t outside;            // Pencere dışına taşan piksel (0 olmalı)
+};
+static HostFramebuffer hostFb;
+
+static uint16_t* hostFbBand() { return hostFb.band; }
+
+static void hostFbWindow(int x0, int y0, int x1, int y1) {
+  hostFb.x0 = x0; hostFb.x1 = x1; hostFb.x = x0; hostFb.y = y0;
+  hostFb.windows++;
+  (void)y1;
+}
+
+static void hostFbPush(uint16_t* buf, int pixels) {
+  for (int n = 0; n < pixels; n++) {
+    if (hostFb.y >= SCREEN_HEIGHT_PX) { hostFb.outside++; continue; }
+    hostFb.pixels[hostFb.y * SCREEN_WIDTH_PX + hostFb.x] = (uint16_t)((buf[n] >> 8) | (buf[n] << 8));
+    if (++hostFb.x == hostFb.x1) { hostFb.x = hostFb.x0; hostFb.y++; }
+  }
+  hostFb.pushedPixels += pixels;
+  hostFb.pushedBytes  += pixels * 2;
+}
+
+static const PixelSink HOST_FB_SINK = { hostFbBand, hostFbWindow, hostFbPush };
+
+inline uint16_t hostPixel(int x, int y) { return hostFb.pixels[y * SCREEN_WIDTH_PX + x]; }
+
+inline void hostFbResetCounters() {
+  hostFb.pushedPixels = hostFb.pushedBytes = hostFb.windows = hostFb.outside = 0;
+}
+
+// İkili PPM (P6), RGB565 -> 8 bit kanallar
+inline bool writePPM(const char* path) {
+  FILE* f = fopen(path, "wb");
+  if (!f) return false;
+  fprintf(f, "P6\n%d %d\n255\n", SCREEN_WIDTH_PX, SCREEN_HEIGHT_PX);
+  for (int n = 0; n < SCREEN_WIDTH_PX * SCREEN_HEIGHT_PX; n++) {
+    uint16_t c = hostFb.pixels[n];
+    uint8_t rgb[3] = { (uint8_t)((c >> 11) * 255 / 31), (uint8_t)(((c >> 5) & 63) * 255 / 63), (uint8_t)((c & 31) * 255 / 31) };
+    fwrite(rgb, 1, 3, f);
+  }
+  return fclose(f) == 0;
+}
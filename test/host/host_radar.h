@@ -0,0 +1,46 @@
+// Testler arası ortak yardımcılar: radar CAN çerçevesi üretimi ve Nextion hattının komutlara ayrılması.
+#pragma once
+#include <limits.h>
+#include <string>
+#include <vector>
+#include "Arduino.h"
+#include "driver/twai.h"
+
+// Radar nesne çerçevesi (0x310 + slot): mesafe/açı/x/y 25 cm adımla, data[7] bit0 = 0 geçerli
+inline void queueRadarTarget(int slot, int x_cm, int y_cm) {
+  twai_message_t msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.identifier       = 0x310 + slot;
+  msg.data_length_code = 8;
+  msg.data[0] = (uint8_t)lround(sqrt((double)x_cm * x_cm + (double)y_cm * y_cm) / 25);
+  msg.data[1] = (uint8_t)(128 + lround(atan2((double)y_cm, (double)x_cm) * 180 / M_PI));
+  msg.data[2] = (uint8_t)(x_cm / 25);
+  msg.data[3] = (uint8_t)(128 + y_cm / 25);
+  hostCanFrames.push_back(msg);
+}
+
+// 0xFF 0xFF 0xFF ile biten komutlar (addt ham verisi içermeyen hat için)
+inline std::vector<std::string> nextionCommands(const std::string& wire) {
+  std::vector<std::string> cmds;
+  size_t start = 0, end;
+  while ((end = wire.find("\xFF\xFF\xFF", start)) != std::string::npos) {
+    cmds.push_back(wire.substr(start, end - start));
+    start = end + 3;
+  }
+  return cmds;
+}
+
+// "<prefix><sayı>" biçimli son komutun değeri; yoksa INT_MIN
+inline int lastValue(const std::vector<std::string>& cmds, const char* prefix) {
+  for (size_t n = cmds.size(); n-- > 0;) {
+    if (cmds[n].compare(0, strlen(prefix), prefix) == 0) return atoi(cmds[n].c_str() + strlen(prefix));
+  }
+  return INT_MIN;
+}
+
+inline int indexOf(const std::vector<std::string>& cmds, const std::string& cmd, size_t from = 0) {
+  for (size_t n = from; n < cmds.size(); n++) {
+    if (cmds[n] == cmd) return (int)n;
+  }
+  return -1;
+}
@@ -0,0 +1,147 @@
+// CAN girişi: slot başına trafik istatistiği (çerçeve, geçersiz, geliş aralığı ortalaması/sapması) ve
+// sensör denetimi (zaman aşımında hata, ilk çerçevede geri alma).
+#include <unity.h>
+#include "Arduino.h"
+#include "host_radar.h"
+#include "radar.h"
+
+static twai_message_t radarFrame(uint32_t id, bool valid) {
+  twai_message_t msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.identifier       = id;
+  msg.data_length_code = 8;
+  msg.data[0] = 20;
+  msg.data[1] = 128;
+  msg.data[2] = 20;
+  msg.data[3] = 128;
+  msg.data[7] = valid ? 0 : 1;
+  return msg;
+}
+
+void setUp() {
+  memset(EEPROM.data, 0xFF, sizeof(EEPROM.data));
+  hostCanFrames.clear();
+  hostMillis = 1000;
+  setup();
+  resetTrafficStats();
+  canFramesOther = 0;
+}
+void tearDown() {}
+
+// 100 ms aralıkla gelen slot: ortalama tam 100 ms (Q4), sapma 0; geçersiz bit sayılır ama hedef yazılmaz.
+// 90/110 ms dönüşümlü aralıkta ortalama 100 ms civarında kalır, sapma artar. Uzun boşluk 4095 ms'de kırpılır.
+void test_slot_stats_track_interval_and_invalid() {
+  const int slot = 5;
+  for (int n = 0; n < 10; n++) {
+    ingestCanFrame(radarFrame(RADAR_ID_FIRST + slot, n != 3), hostMillis);
+    hostMillis += 100;
+  }
+  const SlotStats& s = slotStats[slot];
+  TEST_ASSERT_EQUAL(10, s.frames);
+  TEST_ASSERT_EQUAL(1, s.invalidFrames);
+  TEST_ASSERT_EQUAL(hostMillis - 100, s.lastSeen_ms);
+  TEST_ASSERT_EQUAL(100 << 4, s.meanInterval_q4);
+  TEST_ASSERT_EQUAL(0, s.jitter_q4);
+
+  for (int n = 0; n < 40; n++) {
+    hostMillis += (n & 1) ? 110 : 90;
+    ingestCanFrame(radarFrame(RADAR_ID_FIRST + slot, true), hostMillis);
+  }
+  TEST_ASSERT_INT_WITHIN(5 << 4, 100 << 4, s.meanInterval_q4);
+  TEST_ASSERT_TRUE(s.jitter_q4 >= (5 << 4));
+
+  resetTrafficStats();
+  ingestCanFrame(radarFrame(RADAR_ID_FIRST + slot, true), hostMillis);
+  hostMillis += 10000;
+  ingestCanFrame(radarFrame(RADAR_ID_FIRST + slot, true), hostMillis);
+  TEST_ASSERT_EQUAL(4095 << 4, s.meanInterval_q4);
+}
+
+// Aralığın iki ucu radar slotu, dışı "diğer" sayacı; diğer slotlar etkilenmez
+void test_slot_stats_id_range() {
+  ingestCanFrame(radarFrame(RADAR_ID_FIRST, true), hostMillis);
+  ingestCanFrame(radarFrame(RADAR_ID_LAST, true), hostMillis);
+  ingestCanFrame(radarFrame(RADAR_ID_FIRST - 1, true), hostMillis);
+  ingestCanFrame(radarFrame(RADAR_ID_LAST + 1, true), hostMillis);
+  TEST_ASSERT_EQUAL(1, slotStats[0].frames);
+  TEST_ASSERT_EQUAL(1, slotStats[RADAR_SLOT_COUNT - 1].frames);
+  TEST_ASSERT_EQUAL(2, canFramesOther);
+  uint32_t total = 0;
+  for (int slot = 0; slot < RADAR_SLOT_COUNT; slot++) total += slotStats[slot].frames;
+  TEST_ASSERT_EQUAL(2, total);
+}
+
+// STATS dökümü sadece görülen slotları yazar
+void test_stats_dump_lists_seen_slots() {
+  ingestCanFrame(radarFrame(RADAR_ID_FIRST + 17, true), hostMillis);
+  Serial.clearWire();
+  dumpTrafficStats();
+  TEST_ASSERT_TRUE(Serial.wire.find("0x321") != std::string::npos);
+  TEST_ASSERT_TRUE(Serial.wire.find("0x322") == std::string::npos);
+}
+
+// Denetim periyodu dolmuş, "now" anında çalışır
+static void superviseAt(unsigned long now) {
+  hostMillis = now;
+  lastSupervisionTime = now - SENSOR_SUPERVISION_PERIOD_MS;
+  superviseSensors();
+}
+
+// Beklenen sensör 0 zaman aşımı süresi boyunca sessiz kalınca hataya düşer (sınırda değil, aşınca); beklenmeyen
+// sensör 1 hiç düşmez. Hedef yokken buzzer uzun/seyrek hata desenini çalar. Sensörün ilk çerçevesi (geçersiz
+// bitli olsa da) hatayı hemen kaldırır, buzzer susar, ekrana yazım sonraki kareye kalır.
+void test_sensor_timeout_fault_and_recovery() {
+  processConsoleCommand("SENSOR TIMEOUT 300");
+  TEST_ASSERT_EQUAL(0x01, sensorExpectedMask);
+  sensorFaultMask = 0;
+  unsigned long t0 = hostMillis;
+  ingestCanFrame(radarFrame(RADAR_ID_FIRST + 2, true), t0);
+  ingestCanFrame(radarFrame(RADAR_ID_FIRST + RADAR_OBJECTS_PER_SENSOR, true), t0);
+
+  superviseAt(t0 + 300);
+  TEST_ASSERT_EQUAL(0, sensorFaultMask);
+  superviseAt(t0 + 301);
+  TEST_ASSERT_EQUAL(0x01, sensorFaultMask);
+  superviseAt(t0 + 5000);
+  TEST_ASSERT_EQUAL(0x01, sensorFaultMask);  // Sensör 1 beklenmiyor
+
+  int onMs = 0;
+  for (int n = 0; n < 300; n++) {  // 3 s, 10 ms adım: iki bip
+    hostMillis += 10;
+    handleBuzzer();
+    if (buzzerIsOn) onMs += 10;
+  }
+  TEST_ASSERT_INT_WITHIN(60, 2 * FAULT_BEEP_ON_MS, onMs);
+
+  statusPending = false;
+  size_t wire0 = SerialNextion.wire.size();
+  ingestCanFrame(radarFrame(RADAR_ID_FIRST + 7, false), hostMillis);
+  TEST_ASSERT_EQUAL(0, sensorFaultMask);
+  TEST_ASSERT_TRUE(statusPending);
+  TEST_ASSERT_EQUAL(wire0, SerialNextion.wire.size());
+  hostMillis += 10;
+  handleBuzzer();
+  TEST_ASSERT_FALSE(buzzerIsOn);
+}
+
+// Beklenen maske sensör 1'i de kapsar: sadece susan sensörün biti düşer
+void test_sensor_mask_selects_supervised_sensors() {
+  processConsoleCommand("SENSOR MASK 03");
+  sensorFaultMask = 0;
+  unsigned long t0 = hostMillis;
+  ingestCanFrame(radarFrame(RADAR_ID_FIRST, true), t0);
+  ingestCanFrame(radarFrame(RADAR_ID_FIRST + RADAR_OBJECTS_PER_SENSOR, true), t0);
+  ingestCanFrame(radarFrame(RADAR_ID_FIRST, true), t0 + 400);
+  superviseAt(t0 + DEFAULT_SENSOR_TIMEOUT_MS + 1);
+  TEST_ASSERT_EQUAL(0x02, sensorFaultMask);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_slot_stats_track_interval_and_invalid);
+  RUN_TEST(test_slot_stats_id_range);
+  RUN_TEST(test_stats_dump_lists_seen_slots);
+  RUN_TEST(test_sensor_timeout_fault_and_recovery);
+  RUN_TEST(test_sensor_mask_selects_supervised_sensors);
+  return UNITY_END();
+}
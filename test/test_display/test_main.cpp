@@ -0,0 +1,882 @@
+// Sahne çıkışı: şekil sahnesinde (RENDER DRAW) çizim komutlarının sırası, piksel çıkışının (RENDER TFT)
+// masaüstü çerçeve tamponundaki sonucu, mesafe profili aktarımında (addt) kuyruğun bekletilmesi ve
+// tarama başına profil örneği.
+#include <unity.h>
+#include "Arduino.h"
+#include "host_radar.h"
+#include "radar.h"
+#include "host_framebuffer.h"
+
+static bool isEraseOrClear(const std::string& c) {
+  if (c.compare(0, 4, "cls ") == 0) return true;
+  return c.compare(0, 5, "fill ") == 0 && c.substr(c.rfind(',') + 1) == String(DRAW_BG_COLOR).c_str();
+}
+
+static bool isRedFill(const std::string& c) {
+  return c.compare(0, 5, "fill ") == 0 && c.substr(c.rfind(',') + 1) == String(COLOR_RED).c_str();
+}
+
+// Kuyruk hat boşalana kadar bekletilir (UART dolu), kalan her şey sonra tek seferde yazılır
+static void drainNextion() {
+  SerialNextion.autoDrain = true;
+  SerialNextion.flush();
+  while (nexQueueCount > 0) pumpNextionQueue();
+}
+
+void setUp() {
+  memset(EEPROM.data, 0xFF, sizeof(EEPROM.data));
+  hostCanFrames.clear();
+  memset(scanSlotsSeen, 0, sizeof(scanSlotsSeen));
+  hostMillis = 1000;
+  SerialNextion.autoDrain = true;
+  pixelSink = &HOST_FB_SINK;
+  renderLod          = LOD_TEXT;       // Testlerin değiştirdiği, EEPROM'da olmayan durum
+  renderRate_auto    = true;
+  renderInterval_ms  = RENDER_MIN_MS;
+  memset(&rateCtl, 0, sizeof(rateCtl));
+  rateCtl.last_ms    = hostMillis;
+  profileHead = profileFilled = profileUnsent = 0;
+  refBatch_enabled   = true;
+  nextionPage        = NEX_PAGE_MAIN;
+  nextionLinkUp      = true;
+  pageResyncPending  = false;
+  settingsResyncNext = SETTINGS_ITEM_COUNT;
+  elementTokens_mB   = 0;
+  elementRefill_ms   = hostMillis;
+  setup();
+  processConsoleCommand("PRIO ON");
+  processConsoleCommand("RENDER DRAW");
+  SerialNextion.clearWire();
+}
+void tearDown() {}
+
+// Uyarı karesi kuyrukta beklerken hedef alarm bölgesine girer: kırmızı şerit/marker ne kendi karesinin
+// cls/silmesinin ne de önceki karenin çizimlerinin önüne geçmemeli.
+void test_alarm_frame_keeps_draw_order() {
+  SerialNextion.autoDrain = false;
+  queueRadarTarget(0, 400, 0);
+  loop();
+  hostMillis += 100;
+  queueRadarTarget(0, 100, 0);
+  loop();
+  TEST_ASSERT_EQUAL(ZONE_ALARM, targets.zone[0]);
+  TEST_ASSERT_TRUE(nexQueueCount > 0);  // Önceki kare henüz yazılmamış olmalı
+  drainNextion();
+
+  std::vector<std::string> cmds = nextionCommands(SerialNextion.wire);
+  int firstRed = -1, lastErase = -1;
+  for (int n = 0; n < (int)cmds.size(); n++) {
+    if (firstRed < 0 && isRedFill(cmds[n])) firstRed = n;
+    if (isEraseOrClear(cmds[n])) lastErase = n;
+  }
+  TEST_ASSERT_TRUE(firstRed >= 0);
+  TEST_ASSERT_LESS_THAN(firstRed, lastErase);
+  TEST_ASSERT_EQUAL(0, queueStats.frameReorders);
+}
+
+// Öncelik kapalıyken de sıra aynı kalır (kıyas için)
+void test_fifo_queue_keeps_draw_order() {
+  processConsoleCommand("PRIO OFF");
+  TEST_ASSERT_FALSE(nexPriority_enabled);
+  SerialNextion.autoDrain = false;
+  queueRadarTarget(0, 400, 0);
+  loop();
+  hostMillis += 100;
+  queueRadarTarget(0, 100, 0);
+  loop();
+  drainNextion();
+  TEST_ASSERT_EQUAL(0, queueStats.frameReorders);
+}
+
+// Hattaki ref_stop/ref_star çiftleri iç içe ya da karışık olmamalı; son çiftin indeksleri
+static bool lastFrame(const std::vector<std::string>& cmds, int& stop, int& star) {
+  bool open = false;
+  stop = star = -1;
+  for (int n = 0; n < (int)cmds.size(); n++) {
+    if (cmds[n] == "ref_stop") {
+      if (open) return false;
+      open = true;
+      stop = n;
+    } else if (cmds[n] == "ref_star") {
+      if (!open) return false;
+      open = false;
+      star = n;
+    }
+  }
+  return !open;
+}
+
+// Bileşen modunda hedef yaklaşır, alarma girer ve kaybolur: sendme dışındaki her komut bir ref_stop/ref_star
+// çiftinin içindedir, kare başına tek çift; alarm arka planı marker renginden önce gelir. REFBATCH OFF'ta çift yok.
+void test_every_frame_bracketed_by_ref() {
+  processConsoleCommand("RENDER COMPONENTS");
+  SerialNextion.clearWire();
+  uint32_t frames0 = renderStats.frames;
+  for (int n = 0; n < 12; n++) {
+    hostMillis += 100;
+    queueRadarTarget(0, 600 - 50 * n, 0);
+    loop();
+  }
+  TEST_ASSERT_EQUAL(ZONE_ALARM, targets.zone[0]);
+  hostMillis += TARGET_HOLD_MS + 100;
+  loop();
+  TEST_ASSERT_FALSE(targetVisible);
+
+  std::vector<std::string> cmds = nextionCommands(SerialNextion.wire);
+  bool open = false;
+  int pairs = 0, outside = 0;
+  for (size_t n = 0; n < cmds.size(); n++) {
+    if (cmds[n] == "ref_stop") {
+      TEST_ASSERT_FALSE(open);
+      open = true;
+      pairs++;
+    } else if (cmds[n] == "ref_star") {
+      TEST_ASSERT_TRUE(open);
+      open = false;
+    } else if (!open && cmds[n] != "sendme") {
+      outside++;
+    }
+  }
+  TEST_ASSERT_FALSE(open);
+  TEST_ASSERT_EQUAL(0, outside);
+  TEST_ASSERT_EQUAL((int)(renderStats.frames - frames0), pairs);
+
+  int pic = indexOf(cmds, std::string("page0.pic=") + String(PIC_ID_ALARM).c_str());
+  int red = indexOf(cmds, std::string(MARKER_NAME[0]) + ".pco=" + String(ZONE_COLOR[ZONE_ALARM]).c_str());
+  TEST_ASSERT_TRUE(pic >= 0 && pic < red);
+  int stop = pic;
+  while (cmds[stop] != "ref_stop") stop--;
+  int star = indexOf(cmds, "ref_star", stop);
+  TEST_ASSERT_TRUE(red < star);
+
+  processConsoleCommand("REFBATCH OFF");
+  SerialNextion.clearWire();
+  hostMillis += 100;
+  queueRadarTarget(0, 300, 0);
+  loop();
+  cmds = nextionCommands(SerialNextion.wire);
+  TEST_ASSERT_TRUE(cmds.size() > 0);
+  TEST_ASSERT_EQUAL(-1, indexOf(cmds, "ref_stop"));
+  TEST_ASSERT_EQUAL(-1, indexOf(cmds, "ref_star"));
+}
+
+// Sayısal alanlar (FIELDS NUMERIC, sınıflar CHANGE): ilk gösterimde dört .val ardından vis ...,1; hedef sadece
+// ileri gelince sadece mesafe ve ileri (xX) alanı yazılır, araç ve durum tekrarlanmaz; hedef kaybolunca alanlar
+// gizlenir. Metin modunda .val ve vis yoktur.
+static int countPrefix(const std::vector<std::string>& cmds, const std::string& prefix) {
+  int count = 0;
+  for (size_t n = 0; n < cmds.size(); n++) count += cmds[n].compare(0, prefix.size(), prefix) == 0;
+  return count;
+}
+
+void test_numeric_fields_write_only_changes() {
+  processConsoleCommand("RENDER COMPONENTS");
+  processConsoleCommand("FIELDS NUMERIC");
+  for (int f = 0; f < FIELD_COUNT; f++) processConsoleCommand((std::string("REFRESH ") + ELEMENT_NAME[f] + " CHANGE").c_str());
+  processConsoleCommand(("BUDGET " + String(ELEMENT_BUDGET_MAX_BPS)).c_str());
+  SerialNextion.clearWire();
+  hostMillis += 100;
+  queueRadarTarget(0, 500, 0);
+  loop();
+  std::vector<std::string> cmds = nextionCommands(SerialNextion.wire);
+  TEST_ASSERT_EQUAL(500, lastValue(cmds, "xMesafe.val="));
+  TEST_ASSERT_EQUAL(0, lastValue(cmds, "nAci.val="));
+  TEST_ASSERT_EQUAL(500, lastValue(cmds, "xX.val="));  // İleri (Y etiketi)
+  TEST_ASSERT_EQUAL(0, lastValue(cmds, "xY.val="));
+  int lastVal = -1;
+  for (int n = 0; n < (int)cmds.size(); n++) if (cmds[n].find(".val=") != std::string::npos) lastVal = n;
+  for (int f = 0; f < FIELD_COUNT; f++) TEST_ASSERT_TRUE(indexOf(cmds, std::string("vis ") + FIELD_NUMERIC[f] + ",1") > lastVal);
+  TEST_ASSERT_EQUAL(0, countPrefix(cmds, "tMesafe.txt="));
+
+  SerialNextion.clearWire();
+  hostMillis += 1000;  // İlk gösterimin borcu kovadan ödenir (kova 1 s biriktirir)
+  queueRadarTarget(0, 450, 0);
+  loop();
+  cmds = nextionCommands(SerialNextion.wire);
+  TEST_ASSERT_EQUAL(450, lastValue(cmds, "xMesafe.val="));
+  TEST_ASSERT_EQUAL(450, lastValue(cmds, "xX.val="));
+  TEST_ASSERT_EQUAL(0, countPrefix(cmds, "nAci.val="));
+  TEST_ASSERT_EQUAL(0, countPrefix(cmds, "xY.val="));
+  TEST_ASSERT_EQUAL(0, countPrefix(cmds, "vis "));
+  TEST_ASSERT_EQUAL(0, countPrefix(cmds, "rVehicle."));  // İlk gösterim sadece alanları unutur
+  TEST_ASSERT_EQUAL(0, countPrefix(cmds, "tDurum.txt="));
+
+  SerialNextion.clearWire();
+  hostMillis += TARGET_HOLD_MS + 100;
+  loop();
+  cmds = nextionCommands(SerialNextion.wire);
+  for (int f = 0; f < FIELD_COUNT; f++) TEST_ASSERT_TRUE(indexOf(cmds, std::string("vis ") + FIELD_NUMERIC[f] + ",0") >= 0);
+  TEST_ASSERT_EQUAL(0, countPrefix(cmds, "xMesafe.val="));
+
+  processConsoleCommand("FIELDS TEXT");
+  SerialNextion.clearWire();
+  hostMillis += 100;
+  queueRadarTarget(0, 500, 0);
+  loop();
+  cmds = nextionCommands(SerialNextion.wire);
+  TEST_ASSERT_TRUE(indexOf(cmds, "tMesafe.txt=\"5.00m\"") >= 0);
+  TEST_ASSERT_EQUAL(0, countPrefix(cmds, "xMesafe.val="));
+  for (int f = 0; f < FIELD_COUNT; f++) TEST_ASSERT_EQUAL(-1, indexOf(cmds, std::string("vis ") + FIELD_NUMERIC[f] + ",1"));
+}
+
+// Animasyon (ANIM ON): ilk gösterim x/y ile, sonraki taramada tek "move rTarget,x0,y0,x1,y1,0,süre"; başlangıç
+// ekrandaki konum, bitiş yeni konum, süre ölçülen çizim aralığı 40-500 ms'ye sıkıştırılmış. Paketli protokolde yok.
+static bool lastMove(const std::vector<std::string>& cmds, int arg[7]) {
+  for (size_t n = cmds.size(); n-- > 0;) {
+    if (cmds[n].compare(0, 5, "move ") != 0) continue;
+    char name[16];
+    return sscanf(cmds[n].c_str(), "move %15[^,],%d,%d,%d,%d,%d,%d", name, &arg[0], &arg[1], &arg[2], &arg[3], &arg[4],
+                  &arg[5]) == 7 && strcmp(name, MARKER_NAME[0]) == 0;
+  }
+  return false;
+}
+
+static void moveStep(int x_cm, uint32_t cycle_ms, int arg[7], int from[2]) {
+  SerialNextion.clearWire();
+  hostMillis += MOVE_MAX_MS + 100;  // Ölçülen aralığa katılmaz
+  renderCycle_ms = cycle_ms;
+  from[0] = markers[0].x;
+  from[1] = markers[0].y;
+  queueRadarTarget(0, x_cm, 0);
+  loop();
+  TEST_ASSERT_TRUE(lastMove(nextionCommands(SerialNextion.wire), arg));
+}
+
+void test_move_command_arguments_and_clamp() {
+  processConsoleCommand("RENDER COMPONENTS");
+  processConsoleCommand("ANIM ON");
+  hostMillis += 100;
+  queueRadarTarget(0, 600, 0);
+  loop();
+  std::vector<std::string> cmds = nextionCommands(SerialNextion.wire);
+  int arg[7], from[2];
+  TEST_ASSERT_FALSE(lastMove(cmds, arg));  // İlk gösterim x/y + vis
+  TEST_ASSERT_TRUE(indexOf(cmds, "vis " + std::string(MARKER_NAME[0]) + ",1") >= 0);
+
+  moveStep(500, 150, arg, from);
+  TEST_ASSERT_EQUAL(from[0], arg[0]);
+  TEST_ASSERT_EQUAL(from[1], arg[1]);
+  TEST_ASSERT_EQUAL(markers[0].x, arg[2]);
+  TEST_ASSERT_EQUAL(markers[0].y, arg[3]);
+  TEST_ASSERT_TRUE(arg[3] != arg[1]);
+  TEST_ASSERT_EQUAL(0, arg[4]);
+  TEST_ASSERT_EQUAL(150, arg[5]);
+  TEST_ASSERT_EQUAL(-1, indexOf(nextionCommands(SerialNextion.wire), std::string(MARKER_NAME[0]) + ".y=" +
+                                String(markers[0].y).c_str()));
+
+  moveStep(400, 5, arg, from);
+  TEST_ASSERT_EQUAL(MOVE_MIN_MS, arg[5]);
+  moveStep(300, 5000, arg, from);
+  TEST_ASSERT_EQUAL(MOVE_MAX_MS, arg[5]);
+
+  processConsoleCommand("PROTO PACKED");
+  TEST_ASSERT_EQUAL(0, (int)moveDuration_ms());
+}
+
+// Bileşen modunda uyarı karesi kuyrukta beklerken hedef alarm bölgesine girer: alarm arka planı kendi
+// karesinin ref_stop'u ile ref_star'ı arasında kalır, alarm gecikmesi karede bir kez (ref_star) ölçülür.
+void test_component_alarm_frame_is_atomic() {
+  processConsoleCommand("RENDER COMPONENTS");
+  SerialNextion.autoDrain = false;
+  queueRadarTarget(0, 400, 0);
+  loop();
+  hostMillis += 100;
+  uint32_t alarmCmds0 = queueStats.alarmCmds;
+  queueRadarTarget(0, 100, 0);
+  loop();
+  TEST_ASSERT_EQUAL(ZONE_ALARM, targets.zone[0]);
+  TEST_ASSERT_TRUE(nexQueueCount > 0);
+  drainNextion();
+
+  std::vector<std::string> cmds = nextionCommands(SerialNextion.wire);
+  int pic = indexOf(cmds, std::string("page0.pic=") + String(PIC_ID_ALARM).c_str());
+  TEST_ASSERT_TRUE(pic >= 0);
+  int stop, star;
+  TEST_ASSERT_TRUE(lastFrame(cmds, stop, star));
+  TEST_ASSERT_TRUE(stop < pic && pic < star);  // Alarm karesinin kendi çifti
+  TEST_ASSERT_EQUAL(0, queueStats.frameReorders);
+  TEST_ASSERT_EQUAL(alarmCmds0 + 1, queueStats.alarmCmds);
+}
+
+// Hat doluyken ilk kare tümüyle kuyrukta bekler: alanlar, araç geometrisi ve durum dahil her kare komutu
+// ref_stop/ref_star çiftinin içinde yazılır.
+void test_frame_parts_stay_inside_frame() {
+  processConsoleCommand("RENDER COMPONENTS");
+  SerialNextion.clearWire();
+  SerialNextion.autoDrain = false;
+  SerialNextion.pending   = NEX_TX_HIGH_WATER;
+  queueRadarTarget(0, 500, 0);
+  loop();
+  TEST_ASSERT_EQUAL(0, (int)SerialNextion.wire.size());
+  drainNextion();
+
+  std::vector<std::string> cmds = nextionCommands(SerialNextion.wire);
+  int stop, star;
+  TEST_ASSERT_TRUE(lastFrame(cmds, stop, star));
+  TEST_ASSERT_EQUAL(0, stop);
+  TEST_ASSERT_EQUAL((int)cmds.size() - 1, star);
+  TEST_ASSERT_TRUE(indexOf(cmds, "rVehicle.bco=" + std::string(String(VEHICLE_COLOR).c_str())) >= 0);
+  TEST_ASSERT_TRUE(indexOf(cmds, "tDurum.txt=\"HEDEF\"") >= 0);
+}
+
+// Hat dolu: her 50 ms'de yeni kare gelir, hattan çıkan kareyi yetiştiremez. sendme yoklaması
+// kareler arasında yine yazılır, ekran cevap verdikçe hat kopmuş sayılmaz.
+// Hatta yazılmış sendme'lere ana sayfa cevabı (0x66 00) verilir; cevaplanan sayısı
+static int answerPagePolls(size_t& seen) {
+  int polls = 0;
+  size_t at;
+  while ((at = SerialNextion.wire.find("sendme\xFF\xFF\xFF", seen)) != std::string::npos) {
+    const uint8_t page[5] = { NEX_RET_CURRENT_PAGE, NEX_PAGE_MAIN, 0xFF, 0xFF, 0xFF };
+    SerialNextion.feed(page, 5);
+    seen = at + 9;
+    polls++;
+  }
+  return polls;
+}
+
+void test_sendme_not_starved_by_frames() {
+  processConsoleCommand("RENDER COMPONENTS");
+  processConsoleCommand("RATE OFF");  // Her tarama çizilir
+  processConsoleCommand("MARKERS 4");
+  SerialNextion.autoDrain = false;
+  uint32_t timeouts0 = linkStats.timeouts;
+  size_t seen = 0;
+  int polls = 0;
+  for (int n = 0; n < 100; n++) {
+    hostMillis += 50;
+    for (int t = 0; t < 4; t++) queueRadarTarget(t, 500 - (n % 8) * 25 + t * 100, (n % 5) * 25 - t * 50);
+    loop();
+    SerialNextion.drain(NEXTION_BAUD / 10 / 20);
+    polls += answerPagePolls(seen);
+  }
+  TEST_ASSERT_TRUE(nexQueueCount > 0);  // Kuyruk hiç boşalmadı
+  TEST_ASSERT_TRUE(polls >= 3);
+  TEST_ASSERT_TRUE(nextionLinkUp);
+  TEST_ASSERT_EQUAL(timeouts0, linkStats.timeouts);
+}
+
+// Hat dörtte bir hızda boşalır, dört hedef her taramada yer değiştirir: kuyruk birikince çizim aralığı uzar ve
+// ayrıntı düşer. Hat boşalıp tek hedef kalınca aralık kısalır, ayrıntı (tutma süresi dolunca) metne döner.
+void test_render_rate_follows_backlog() {
+  processConsoleCommand("RENDER COMPONENTS");
+  processConsoleCommand("MARKERS 4");
+  SerialNextion.autoDrain = false;
+  uint32_t downs0 = rateCtl.lodDowns, ups0 = rateCtl.lodUps;
+  size_t seen = 0;
+  int maxBacklog = 0;
+  for (int n = 0; n < 60; n++) {
+    hostMillis += 100;
+    for (int t = 0; t < 4; t++) queueRadarTarget(t, 600 - (n % 8) * 25 + t * 100, (n % 5) * 25 - t * 50);
+    loop();
+    maxBacklog = max(maxBacklog, nextionTxBacklog());
+    SerialNextion.drain(NEXTION_BAUD / 10 / 40);  // Ekran hattın dörtte biri hızında okur
+    answerPagePolls(seen);
+  }
+  printf("RATE yuk: bekleyen en fazla %d bayt, aralik %u ms, ayrinti %d\n", maxBacklog, renderInterval_ms, renderLod);
+  TEST_ASSERT_TRUE(maxBacklog > FRAME_BYTE_BUDGET / 2);
+  TEST_ASSERT_TRUE(renderInterval_ms > RENDER_LOD_DOWN_MS);
+  TEST_ASSERT_TRUE(renderLod < LOD_TEXT);
+  TEST_ASSERT_TRUE(rateCtl.lodDowns > downs0);
+  uint32_t loadedInterval = renderInterval_ms;
+
+  SerialNextion.autoDrain = true;
+  SerialNextion.flush();
+  for (int n = 0; n < 100; n++) {
+    hostMillis += 100;
+    queueRadarTarget(0, 600 - (n % 8) * 25, 0);
+    loop();
+    answerPagePolls(seen);
+  }
+  printf("RATE bos: aralik %u ms, ayrinti %d\n", renderInterval_ms, renderLod);
+  TEST_ASSERT_TRUE(renderInterval_ms < loadedInterval);
+  TEST_ASSERT_EQUAL(LOD_TEXT, renderLod);
+  TEST_ASSERT_TRUE(rateCtl.lodUps > ups0);
+}
+
+// Önde 4 m hedefli sabit sahne: ilk kare tüm ekranı gönderir; hedef bir adım yaklaşınca sadece marker
+// bölgesi gider ve farkla çizilen kare tam çizimle piksel piksel aynıdır. Sahne radar_scene.ppm'e yazılır.
+void test_framebuffer_renders_fixed_scene() {
+  const int W = SCREEN_WIDTH_PX, H = SCREEN_HEIGHT_PX, S = TARGET_OBJECT_SIZE_PX;
+  processConsoleCommand("RENDER TFT");
+  TEST_ASSERT_EQUAL(RENDERER_TFT, sceneRenderer());
+  hostFbResetCounters();
+  queueRadarTarget(0, 400, 0);
+  loop();
+  TEST_ASSERT_EQUAL(W * H, hostFb.pushedPixels);
+  TEST_ASSERT_EQUAL(2 * W * H, hostFb.pushedBytes);
+  TEST_ASSERT_EQUAL(0, hostFb.outside);
+  TEST_ASSERT_TRUE(writePPM("radar_scene.ppm"));
+
+  int zone = targets.zone[0], grid = ZONE_GRID_CM[zone];
+  int vx, vw, px, py;
+  vehicleGeometry(grid, vx, vw);
+  mapTargetToPixels(400, 0, grid, px, py);
+  int corridor_x = W / 2 - roundDiv((int32_t)halfCorridor_cm * W, grid);
+  TEST_ASSERT_EQUAL(ZONE_COLOR[zone], hostPixel(W / 2, DRAW_ZONE_BAR_PX / 2));
+  TEST_ASSERT_EQUAL(VEHICLE_COLOR, hostPixel(vx + vw / 2, H - VEHICLE_HEIGHT_PX / 2));
+  TEST_ASSERT_EQUAL(ZONE_COLOR[zone], hostPixel(px + S / 2, py + S / 2));
+  TEST_ASSERT_EQUAL(DRAW_CORRIDOR_COLOR, hostPixel(corridor_x, DRAW_ZONE_BAR_PX + 1));
+  TEST_ASSERT_EQUAL(DRAW_BG_COLOR, hostPixel(corridor_x + 1, DRAW_ZONE_BAR_PX + 1));
+
+  hostFbResetCounters();
+  hostMillis += 300;
+  queueRadarTarget(0, 375, 0);
+  loop();
+  TEST_ASSERT_EQUAL(zone, targets.zone[0]);
+  TEST_ASSERT_TRUE(hostFb.pushedPixels > 0);
+  TEST_ASSERT_LESS_OR_EQUAL(2 * S * S, hostFb.pushedPixels);
+  TEST_ASSERT_EQUAL(2 * hostFb.pushedPixels, hostFb.pushedBytes);
+  TEST_ASSERT_EQUAL(0, hostFb.outside);
+
+  static uint16_t incremental[SCREEN_WIDTH_PX * SCREEN_HEIGHT_PX];
+  memcpy(incremental, hostFb.pixels, sizeof(incremental));
+  drawFullPending = true;
+  flushDrawFrame();
+  TEST_ASSERT_EQUAL(0, memcmp(incremental, hostFb.pixels, sizeof(incremental)));
+}
+
+// Sahne ve marker komutlarının hattaki baytı (3 x 0xFF dahil); alanlar, durum ve ref_stop/ref_star hariç
+static int sceneWireBytes(const std::vector<std::string>& cmds) {
+  static const char* const PREFIX[] = { "page0.pic=", "rVehicle.", "rTarget", "vis rTarget", "vScene.val=", "vT" };
+  int bytes = 0;
+  for (size_t n = 0; n < cmds.size(); n++) {
+    for (size_t p = 0; p < sizeof(PREFIX) / sizeof(PREFIX[0]); p++) {
+      if (cmds[n].compare(0, strlen(PREFIX[p]), PREFIX[p]) != 0) continue;
+      bytes += cmds[n].size() + 3;
+      break;
+    }
+  }
+  return bytes;
+}
+
+// Sabit sahne: hedef 6 m'de görünür, 25 cm yaklaşıp yana kayar, sonra bir üst bölgeye girer.
+// Her adımın sahne+marker baytı; hatta ölçülen, diğer kodlamanın sayacıyla (STATS) birlikte döner.
+enum { STEP_APPEAR, STEP_MOVE, STEP_ZONE, STEP_COUNT };
+static void encodeFixedScene(const char* proto, int wire[STEP_COUNT], int other[STEP_COUNT]) {
+  const int X[STEP_COUNT] = { 600, 575, 375 }, Y[STEP_COUNT] = { 0, 25, 25 };
+  setUp();
+  processConsoleCommand("RENDER COMPONENTS");
+  processConsoleCommand(proto);
+  bool packed = (displayOptions & DISPLAY_OPT_PACKED) != 0;
+  for (int step = 0; step < STEP_COUNT; step++) {
+    SerialNextion.clearWire();
+    elementTokens_mB = (int32_t)elementBudget_Bps * 1000;  // Araç bayt bütçesi yüzünden ertelenmesin
+    uint32_t text0 = renderStats.sceneTextBytes, packed0 = renderStats.scenePackedBytes;
+    hostMillis += 100;
+    queueRadarTarget(0, X[step], Y[step]);
+    loop();
+    wire[step]  = sceneWireBytes(nextionCommands(SerialNextion.wire));
+    other[step] = packed ? renderStats.sceneTextBytes - text0 : renderStats.scenePackedBytes - packed0;
+    TEST_ASSERT_EQUAL(packed ? renderStats.scenePackedBytes - packed0 : renderStats.sceneTextBytes - text0, wire[step]);
+  }
+}
+
+// Bit düzeni README'deki tablo (vT: x 0-9, y 10-19, bölge 20-21, görünür 22; vScene: resim 0-7,
+// araç x 8-17, genişlik 18-27); bayt sayıları 272x480 için README'deki karşılaştırma.
+void test_packed_protocol_layout_and_bytes() {
+  int text[STEP_COUNT], packed[STEP_COUNT], textCounted[STEP_COUNT], packedCounted[STEP_COUNT];
+  encodeFixedScene("PROTO TEXT", text, packedCounted);
+  encodeFixedScene("PROTO PACKED", packed, textCounted);
+
+  std::vector<std::string> cmds = nextionCommands(SerialNextion.wire);  // Bölge adımı, paketli
+  uint32_t vT = (uint32_t)lastValue(cmds, "vT0.val="), vScene = (uint32_t)lastValue(cmds, "vScene.val=");
+  const MarkerState& m = markers[markerOf(0)];
+  int zone = targets.zone[0], vx, vw;
+  vehicleGeometry(ZONE_GRID_CM[zone], vx, vw);
+  TEST_ASSERT_EQUAL(m.x, vT & 1023);
+  TEST_ASSERT_EQUAL(m.y, (vT >> 10) & 1023);
+  TEST_ASSERT_EQUAL(zone, (vT >> 20) & 3);
+  TEST_ASSERT_EQUAL(1, vT >> 22);
+  TEST_ASSERT_EQUAL(ZONE_PIC_ID[zone], vScene & 255);
+  TEST_ASSERT_EQUAL(vx, (vScene >> 8) & 1023);
+  TEST_ASSERT_EQUAL(vw, vScene >> 18);
+
+  const int TEXT_BYTES[STEP_COUNT] = { 165, 46, 150 }, PACKED_BYTES[STEP_COUNT] = { 40, 18, 40 };
+  for (int step = 0; step < STEP_COUNT; step++) {
+    printf("PROTO adim %d: metin %d bayt, paketli %d bayt\n", step, text[step], packed[step]);
+    TEST_ASSERT_EQUAL(TEXT_BYTES[step], text[step]);
+    TEST_ASSERT_EQUAL(PACKED_BYTES[step], packed[step]);
+    TEST_ASSERT_EQUAL(text[step], textCounted[step]);      // STATS diğer kodlamayı doğru sayar
+    TEST_ASSERT_EQUAL(packed[step], packedCounted[step]);
+  }
+}
+
+// Sensör olayı CAN yolunda ekrana yazmaz: durum bayrağı kurulur, metin sonraki karede öğe zamanlayıcısından
+// (EL_STATUS) ref_stop/ref_star içinde gider.
+static bool statusInFrame(const char* text) {
+  std::vector<std::string> cmds = nextionCommands(SerialNextion.wire);
+  int stop, star;
+  int at = indexOf(cmds, std::string("tDurum.txt=\"") + text + "\"");
+  return lastFrame(cmds, stop, star) && stop < at && at < star;
+}
+
+void test_sensor_status_written_in_next_frame() {
+  processConsoleCommand("RENDER COMPONENTS");
+  sensorFaultMask      = 0;
+  sensorLastSeen_ms[0] = hostMillis;
+  lastSupervisionTime  = hostMillis;
+  statusPending        = false;
+  SerialNextion.clearWire();
+
+  hostMillis += sensorTimeout_ms + SENSOR_SUPERVISION_PERIOD_MS;
+  superviseSensors();
+  TEST_ASSERT_EQUAL(0x01, sensorFaultMask);
+  TEST_ASSERT_TRUE(statusPending);
+  TEST_ASSERT_EQUAL(0, (int)SerialNextion.wire.size());
+  uint32_t sent0 = elementStats.sent[EL_STATUS];
+  loop();
+  TEST_ASSERT_TRUE(statusInFrame("SENSOR HATA"));
+  TEST_ASSERT_EQUAL(sent0 + 1, elementStats.sent[EL_STATUS]);
+  TEST_ASSERT_FALSE(statusPending);
+
+  SerialNextion.clearWire();
+  markSensorAlive(0, hostMillis);
+  TEST_ASSERT_EQUAL(0, sensorFaultMask);
+  TEST_ASSERT_TRUE(statusPending);
+  TEST_ASSERT_EQUAL(0, (int)SerialNextion.wire.size());
+  hostMillis += 100;  // Durum değişimi kovadan ödenir
+  loop();
+  TEST_ASSERT_TRUE(statusInFrame("Temiz"));
+  TEST_ASSERT_EQUAL(sent0 + 2, elementStats.sent[EL_STATUS]);
+}
+
+// Ayrıntı düşükken (alanlar park) durum da öğe zamanlayıcısından geçer: "HEDEF" karede bir kez yazılır,
+// sayaçta görünür; sonraki karelerde tekrar gitmez.
+void test_parked_status_goes_through_scheduler() {
+  processConsoleCommand("RENDER COMPONENTS");
+  sensorFaultMask = 0;
+  renderLod = LOD_POSITION;
+  rateCtl.lodHoldUntil_ms = hostMillis + 60000;
+  uint32_t sent0 = elementStats.sent[EL_STATUS];
+  SerialNextion.clearWire();
+  queueRadarTarget(0, 500, 0);
+  loop();
+  TEST_ASSERT_TRUE(fieldsParked);
+  TEST_ASSERT_TRUE(statusInFrame("HEDEF"));
+  TEST_ASSERT_EQUAL(sent0 + 1, elementStats.sent[EL_STATUS]);
+
+  SerialNextion.clearWire();
+  for (int n = 1; n <= 3; n++) {
+    hostMillis += 100;
+    queueRadarTarget(0, 500 - 50 * n, 0);
+    loop();
+  }
+  TEST_ASSERT_EQUAL(-1, indexOf(nextionCommands(SerialNextion.wire), "tDurum.txt=\"HEDEF\""));
+  TEST_ASSERT_EQUAL(sent0 + 1, elementStats.sent[EL_STATUS]);
+}
+
+static void feedReturn(uint8_t code) {
+  const uint8_t msg[4] = { code, 0xFF, 0xFF, 0xFF };
+  SerialNextion.feed(msg, 4);
+  handleNextionInput();
+}
+
+// Ekran yeniden açılır: 00 00 00 ardından 0x88. İlk tetik senkronu başlatır, ikincisi baştan başlatmaz;
+// her ikisi de bekleyen cevapları ve sayfayı unutur (açılış ekranı ana sayfadadır).
+static void feedStartup() {
+  const uint8_t msg[6] = { 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF };
+  SerialNextion.feed(msg, 6);
+  handleNextionInput();
+}
+
+static void releaseAcks() {
+  while (nexAckCount > 0) feedReturn(NEX_RET_SUCCESS);
+}
+
+void test_reboot_double_trigger_resyncs_once() {
+  processConsoleCommand("FLOW ON");
+  releaseAcks();
+  nextionLinkUp      = true;
+  settingsResyncNext = SETTINGS_ITEM_COUNT;
+  memset(&linkStats, 0, sizeof(linkStats));
+  sendCommand("t0.txt=\"x\"");
+  nextionPage = 1;
+
+  feedStartup();
+  TEST_ASSERT_EQUAL(1, linkStats.startups);
+  TEST_ASSERT_EQUAL(1, linkStats.resyncs);
+  TEST_ASSERT_EQUAL(0, nexAckCount);
+  TEST_ASSERT_EQUAL(NEX_PAGE_MAIN, nextionPage);
+  TEST_ASSERT_TRUE(pageResyncPending);
+
+  for (int n = 0; n < 4; n++) {
+    loop();
+    releaseAcks();
+  }
+  int next = settingsResyncNext;
+  TEST_ASSERT_TRUE(next > 0 && next < SETTINGS_ITEM_COUNT);
+  sendCommand("t0.txt=\"y\"");
+  nextionPage = 1;
+
+  feedReturn(NEX_RET_READY);
+  TEST_ASSERT_EQUAL(1, linkStats.readies);
+  TEST_ASSERT_EQUAL(1, linkStats.resyncs);
+  TEST_ASSERT_EQUAL(1, linkStats.ignored);
+  TEST_ASSERT_EQUAL(next, settingsResyncNext);
+  TEST_ASSERT_EQUAL(0, nexAckCount);
+  TEST_ASSERT_EQUAL(NEX_PAGE_MAIN, nextionPage);
+}
+
+// Hat kopar, sonra ilk bayt gelir: tam senkron başlar ama ekran açılmadığı için sayfa ve bekleyen
+// cevaplar korunur; mesajın kendisi de işlenir (cevap krediyi geri verir).
+void test_link_down_then_first_byte_resyncs() {
+  processConsoleCommand("FLOW ON");
+  releaseAcks();
+  nextionLinkUp      = true;
+  settingsResyncNext = SETTINGS_ITEM_COUNT;
+  memset(&linkStats, 0, sizeof(linkStats));
+  sendCommand("t0.txt=\"x\"");
+  sendCommand("t1.txt=\"x\"");
+  nextionPage = 1;
+
+  hostMillis += NEXTION_LINK_TIMEOUT_MS + 1;
+  superviseNextionLink(hostMillis);
+  TEST_ASSERT_FALSE(nextionLinkUp);
+  TEST_ASSERT_EQUAL(1, linkStats.timeouts);
+
+  uint32_t acks0 = flowStats.acks;
+  feedReturn(NEX_RET_SUCCESS);
+  TEST_ASSERT_TRUE(nextionLinkUp);
+  TEST_ASSERT_EQUAL(1, linkStats.resyncs);
+  TEST_ASSERT_EQUAL(0, settingsResyncNext);
+  TEST_ASSERT_TRUE(pageResyncPending);
+  TEST_ASSERT_EQUAL(1, nextionPage);
+  TEST_ASSERT_EQUAL(acks0 + 1, flowStats.acks);
+  TEST_ASSERT_EQUAL(1, nexAckCount);
+}
+
+// Akış kontrolü açık, ekran hiç cevap vermez: kuyruk dolana kadar komut, ardından sığmayan uzun komut.
+// Cevabı beklenen komut kredi sınırını aşmaz; yazılamayanlar düşer, ilk kredide ekran önbelleği yenilenir.
+void test_flow_queue_full_respects_credits() {
+  processConsoleCommand("FLOW ON");
+  hostMillis += NEX_ACK_TIMEOUT_MS + 1;
+  expireNextionAcks(hostMillis);  // bkcmd=3 ve protokol komutları
+  memset(&flowStats, 0, sizeof(flowStats));
+  SerialNextion.clearWire();
+
+  for (int n = 0; n < NEX_QUEUE_LEN + NEX_CREDIT_LIMIT + 8; n++) sendCommand("t" + String(n) + ".txt=\"x\"");
+  std::string longText(NEX_CMD_MAX + 4, 'a');
+  sendCommand(String("tDurum.txt=\"") + longText.c_str() + "\"");
+  TEST_ASSERT_EQUAL(NEX_CREDIT_LIMIT, (int)nextionCommands(SerialNextion.wire).size());
+  TEST_ASSERT_EQUAL(NEX_CREDIT_LIMIT, nexAckCount);
+  TEST_ASSERT_EQUAL(NEX_CREDIT_LIMIT, flowStats.outstandingMax);
+  TEST_ASSERT_EQUAL(NEX_QUEUE_LEN, nexQueueCount);
+  TEST_ASSERT_EQUAL(9, flowStats.dropped);
+  TEST_ASSERT_TRUE(nexOutputDropped);
+
+  // Ekran cevaplamaya başlar: kuyruk kredi kadar boşalır, sonra ekran önbelleği yenilenir
+  for (int round = 0; round < 4 && nexOutputDropped; round++) {
+    for (int k = 0; k < NEX_CREDIT_LIMIT; k++) feedReturn(NEX_RET_SUCCESS);
+    loop();
+    TEST_ASSERT_LESS_OR_EQUAL(NEX_CREDIT_LIMIT, nexAckCount);
+  }
+  TEST_ASSERT_EQUAL(NEX_CREDIT_LIMIT, flowStats.outstandingMax);
+  TEST_ASSERT_FALSE(nexOutputDropped);
+}
+
+static int errorKind(uint8_t code) {
+  int kind = 0;
+  while (kind < NEX_ERROR_KINDS && NEX_ERRORS[kind].code != code) kind++;
+  return kind;
+}
+
+// Her dönüş (0x01, hata kodu, sendme'nin 0x66 cevabı) bir kredi iade eder. Halka dolunca alarm komutları
+// en yeni kayda eklenir: krediyi cevap ya da zaman aşımı gelene kadar tutar, sessizce bırakılmaz.
+void test_flow_returns_release_credits() {
+  processConsoleCommand("FLOW ON");
+  hostMillis += NEX_ACK_TIMEOUT_MS + 1;
+  expireNextionAcks(hostMillis);
+  memset(&flowStats, 0, sizeof(flowStats));
+
+  for (int n = 0; n < 3; n++) sendCommand("t" + String(n) + ".txt=\"x\"");
+  TEST_ASSERT_EQUAL(3, nexAckCount);
+  feedReturn(NEX_RET_SUCCESS);
+  TEST_ASSERT_EQUAL(2, nexAckCount);
+  TEST_ASSERT_EQUAL(1, flowStats.acks);
+  feedReturn(0x1A);
+  TEST_ASSERT_EQUAL(1, nexAckCount);
+  TEST_ASSERT_EQUAL(1, flowStats.errors[errorKind(0x1A)]);
+  const uint8_t page[5] = { NEX_RET_CURRENT_PAGE, NEX_PAGE_MAIN, 0xFF, 0xFF, 0xFF };
+  SerialNextion.feed(page, 5);
+  handleNextionInput();
+  TEST_ASSERT_EQUAL(0, nexAckCount);
+  TEST_ASSERT_EQUAL(NEX_CREDIT_LIMIT, nextionCredits());
+
+  for (int n = 0; n < NEX_ACK_RING + 5; n++) sendCommand("page 0", NEX_PRIO_ALARM);
+  TEST_ASSERT_EQUAL(NEX_ACK_RING + 5, nexAckCount);
+  TEST_ASSERT_EQUAL(5, flowStats.merged);
+  TEST_ASSERT_EQUAL(NEX_CREDIT_LIMIT - NEX_ACK_RING - 5, nextionCredits());
+  for (int n = 0; n < NEX_ACK_RING + 4; n++) feedReturn(NEX_RET_SUCCESS);
+  TEST_ASSERT_EQUAL(1, nexAckCount);
+  feedReturn(NEX_RET_SUCCESS);
+  TEST_ASSERT_EQUAL(0, nexAckCount);
+
+  for (int n = 0; n < NEX_ACK_RING + 5; n++) sendCommand("page 0", NEX_PRIO_ALARM);
+  hostMillis += NEX_ACK_TIMEOUT_MS + 1;
+  expireNextionAcks(hostMillis);
+  TEST_ASSERT_EQUAL(0, nexAckCount);
+  TEST_ASSERT_EQUAL(NEX_ACK_RING + 5, flowStats.timeouts);
+  TEST_ASSERT_EQUAL(NEX_CREDIT_LIMIT, nextionCredits());
+}
+
+// Profil noktası olan, alarm bölgesi dışında bir hedefle addt aktarımını başlatır (WAIT_READY)
+static void startProfileTransfer() {
+  processConsoleCommand("RENDER COMPONENTS");
+  for (int scan = 0; scan < 3; scan++) {
+    hostMillis += 100;
+    queueRadarTarget(0, 600, 0);
+    loop();
+  }
+  processConsoleCommand("PROFILE ON");
+  hostMillis += PROFILE_PERIOD_MS;
+  queueRadarTarget(0, 600, 0);
+  loop();
+  TEST_ASSERT_EQUAL(PROFILE_WAIT_READY, profileState);
+}
+
+// Aktarım sürerken kuyruk dolsa da, sığmayan uzun komut gelse de hatta hiçbir komut yazılmaz
+void test_profile_transfer_writes_nothing_between() {
+  startProfileTransfer();
+  SerialNextion.clearWire();
+  for (int n = 0; n < NEX_QUEUE_LEN + 8; n++) sendCommand("t" + String(n) + ".txt=\"x\"", NEX_PRIO_LOW);
+  std::string longText(NEX_CMD_MAX + 4, 'a');
+  sendCommand(String("tDurum.txt=\"") + longText.c_str() + "\"");
+  sendCommand("page 0", NEX_PRIO_ALARM);  // Dolu kuyrukta alarm yer bulur
+  TEST_ASSERT_EQUAL(0, (int)SerialNextion.wire.size());
+  TEST_ASSERT_EQUAL(NEX_QUEUE_LEN, nexQueueCount);
+  TEST_ASSERT_EQUAL(10, profileStats.dropped);
+
+  feedReturn(NEX_RET_ADDT_READY);
+  TEST_ASSERT_EQUAL(profileBurstLen, (int)SerialNextion.wire.size());  // Sadece ham veri
+  feedReturn(NEX_RET_ADDT_DONE);
+  TEST_ASSERT_EQUAL(PROFILE_IDLE, profileState);
+  TEST_ASSERT_FALSE(nexOutputDropped);
+
+  // Ham veriden sonra ilk komut alarm; düşen komutlar yüzünden bileşenler yeniden gönderilecek
+  std::vector<std::string> cmds = nextionCommands(SerialNextion.wire.substr(profileBurstLen));
+  TEST_ASSERT_TRUE(cmds.size() > 0);
+  TEST_ASSERT_TRUE(cmds[0] == "page 0");
+  TEST_ASSERT_EQUAL(-1, renderedTarget);
+}
+
+// Bir döngüde boşaltılan üç tarama üç nokta; tek taramalık döngüler tarama başına bir nokta
+void test_profile_sample_per_scan() {
+  processConsoleCommand("PROFILE ON");
+  int before = profileFilled;
+  for (int scan = 0; scan < 3; scan++) {
+    queueRadarTarget(0, 600, 0);
+    queueRadarTarget(1, 800, 100);
+  }
+  loop();
+  TEST_ASSERT_EQUAL(before + 2, profileFilled);  // Üçüncü tarama sonrakinin ilk çerçevesinde kaydedilir
+  for (int scan = 0; scan < 2; scan++) {
+    hostMillis += 50;
+    queueRadarTarget(0, 600, 0);
+    queueRadarTarget(1, 800, 100);
+    loop();
+  }
+  TEST_ASSERT_EQUAL(before + 4, profileFilled);
+  hostMillis += 50;
+  loop();  // Çerçevesiz döngü nokta eklemez
+  TEST_ASSERT_EQUAL(before + 4, profileFilled);
+}
+
+static void queueInvalidTarget(int slot) {
+  twai_message_t msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.identifier       = 0x310 + slot;
+  msg.data_length_code = 8;
+  msg.data[7]          = 0x01;
+  hostCanFrames.push_back(msg);
+}
+
+// Dört hedef, havuz 4. İlk kare (araç, alanlar) bütçeyi doldurur: ek hedefler çizilmez, marker'ları boş kalır.
+// Sonraki karede ek hedefler öncelik sırasıyla rTarget1-3'e bağlanır. Kaybolan izin marker'ı gizlenir, diğer
+// izler marker'ını korur; iz geri gelince boş marker'ı alır. Kuyrukta bir kare bütçesi bekliyorsa sadece
+// birincil hedef çizilir. MARKERS 1 ek marker'ları bırakır ve kaydedilir.
+void test_marker_pool_and_frame_budget() {
+  processConsoleCommand("RENDER COMPONENTS");
+  processConsoleCommand("RATE OFF");
+  processConsoleCommand("MARKERS 4");
+  TEST_ASSERT_EQUAL(4, markerPoolSize);
+  int markerOfSlot[4];
+  for (int n = 0; n < 2; n++) {
+    SerialNextion.clearWire();
+    uint32_t dropped0 = renderStats.budgetDropped;
+    hostMillis += 100;
+    for (int t = 0; t < 4; t++) queueRadarTarget(t, 300 + t * 100, t * 50);
+    loop();
+    std::vector<std::string> cmds = nextionCommands(SerialNextion.wire);
+    if (n == 0) {
+      TEST_ASSERT_EQUAL(3, renderStats.budgetDropped - dropped0);
+      TEST_ASSERT_EQUAL(0, markerOf(0));
+      for (int t = 1; t < 4; t++) TEST_ASSERT_EQUAL(-1, markerOf(t));
+      TEST_ASSERT_EQUAL(-1, indexOf(cmds, "vis rTarget1,1"));
+    } else {
+      TEST_ASSERT_EQUAL(0, renderStats.budgetDropped - dropped0);
+      for (int t = 0; t < 4; t++) TEST_ASSERT_EQUAL(t, markerOf(t));
+      TEST_ASSERT_TRUE(indexOf(cmds, "vis rTarget3,1") >= 0);
+    }
+  }
+  for (int t = 0; t < 4; t++) markerOfSlot[t] = markerOf(t);
+
+  SerialNextion.clearWire();
+  hostMillis += 100;
+  for (int t = 0; t < 4; t++) {
+    if (t == 2) queueInvalidTarget(t);
+    else        queueRadarTarget(t, 300 + t * 100, t * 50);
+  }
+  loop();
+  std::vector<std::string> cmds = nextionCommands(SerialNextion.wire);
+  TEST_ASSERT_TRUE(indexOf(cmds, "vis rTarget2,0") >= 0);
+  TEST_ASSERT_EQUAL(-1, markerOf(2));
+  TEST_ASSERT_EQUAL(markerOfSlot[1], markerOf(1));
+  TEST_ASSERT_EQUAL(markerOfSlot[3], markerOf(3));
+
+  hostMillis += 100;
+  queueRadarTarget(2, 550, 0);
+  loop();
+  TEST_ASSERT_EQUAL(2, markerOf(2));
+
+  SerialNextion.autoDrain = false;
+  sendCommand("tPad.txt=\"" + String(std::string(FRAME_BYTE_BUDGET, 'x').c_str()) + "\"");
+  TEST_ASSERT_TRUE(nextionTxBacklog() >= FRAME_BYTE_BUDGET);
+  uint32_t dropped0 = renderStats.budgetDropped;
+  hostMillis += 100;
+  for (int t = 0; t < 4; t++) queueRadarTarget(t, 275 + t * 100, t * 50);
+  loop();
+  TEST_ASSERT_EQUAL(3, renderStats.budgetDropped - dropped0);
+  TEST_ASSERT_EQUAL(0, markerOf(0));
+  for (int t = 1; t < 4; t++) TEST_ASSERT_EQUAL(-1, markerOf(t));
+  drainNextion();
+
+  processConsoleCommand("MARKERS 1");
+  TEST_ASSERT_EQUAL(1, EEPROM.data[ADDR_MARKER_POOL]);
+  TEST_ASSERT_FALSE(markers[1].shown);
+  TEST_ASSERT_FALSE(markers[3].shown);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_alarm_frame_keeps_draw_order);
+  RUN_TEST(test_fifo_queue_keeps_draw_order);
+  RUN_TEST(test_every_frame_bracketed_by_ref);
+  RUN_TEST(test_numeric_fields_write_only_changes);
+  RUN_TEST(test_move_command_arguments_and_clamp);
+  RUN_TEST(test_marker_pool_and_frame_budget);
+  RUN_TEST(test_component_alarm_frame_is_atomic);
+  RUN_TEST(test_frame_parts_stay_inside_frame);
+  RUN_TEST(test_sendme_not_starved_by_frames);
+  RUN_TEST(test_render_rate_follows_backlog);
+  RUN_TEST(test_framebuffer_renders_fixed_scene);
+  RUN_TEST(test_sensor_status_written_in_next_frame);
+  RUN_TEST(test_parked_status_goes_through_scheduler);
+  RUN_TEST(test_flow_queue_full_respects_credits);
+  RUN_TEST(test_flow_returns_release_credits);
+  RUN_TEST(test_reboot_double_trigger_resyncs_once);
+  RUN_TEST(test_link_down_then_first_byte_resyncs);
+  RUN_TEST(test_packed_protocol_layout_and_bytes);
+  RUN_TEST(test_profile_transfer_writes_nothing_between);
+  RUN_TEST(test_profile_sample_per_scan);
+  return UNITY_END();
+}
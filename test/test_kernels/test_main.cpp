@@ -0,0 +1,87 @@
+// Hedef çekirdekleri: SoA depo ile AoS karşılaştırma tabanı aynı sonucu vermeli; BENCH iki düzeni ölçer.
+#include <unity.h>
+#include "Arduino.h"
+#include "host_radar.h"
+#include "radar.h"
+
+// Dağınık hedefler: önde/yanlarda, bir kısmı koridor içinde, mesafeler tüm bölgelere yayılır
+static void fillTargets(uint32_t seed) {
+  for (int i = 0; i < RADAR_SLOT_COUNT; i++) {
+    seed = seed * 1103515245u + 12345u;
+    targets.rawX[i]     = (uint8_t)(seed >> 8);
+    targets.rawY[i]     = (uint8_t)(96 + ((seed >> 16) & 63));
+    targets.rawRange[i] = (uint8_t)(seed >> 24);
+    targets.rawAngle[i] = 128;
+    targets.seen_ms[i]  = millis();
+    targets.flags[i]    = TGT_ACTIVE | TGT_FRESH;
+  }
+  decodeTargets();
+}
+
+static void curvePath(int32_t radius_cm) {
+  int32_t inner = abs(radius_cm) - halfCorridor_cm, outer = abs(radius_cm) + halfCorridor_cm;
+  pathModel.centerY_cm  = radius_cm;
+  pathModel.innerSq_cm2 = inner * inner;
+  pathModel.outerSq_cm2 = outer * outer;
+  pathModel.curved      = true;
+  steeringSeen_ms = speedSeen_ms = millis();
+}
+
+void setUp() {
+  memset(EEPROM.data, 0xFF, sizeof(EEPROM.data));
+  hostMillis = 1000;
+  setup();
+  Serial.clearWire();
+}
+void tearDown() {}
+
+void test_corridor_matches_records() {
+  static TargetRecord aos[RADAR_SLOT_COUNT];
+  fillTargets(1);
+  copyTargetsToRecords(aos);
+
+  pathModel.curved = false;
+  testCorridor();
+  testCorridorRecords(aos, false);
+  TEST_ASSERT_EQUAL(0, countRecordMismatches(aos));
+
+  const int32_t RADII[] = { 1500, -1500, 600, -4000 };
+  for (int r = 0; r < 4; r++) {
+    curvePath(RADII[r]);
+    testCorridor();
+    testCorridorRecords(aos, true);
+    TEST_ASSERT_EQUAL(0, countRecordMismatches(aos));
+  }
+}
+
+void test_zones_match_records() {
+  static TargetRecord aos[RADAR_SLOT_COUNT];
+  fillTargets(7);
+  for (int zoom = 0; zoom < 2; zoom++) {
+    autoZoom_enabled = zoom;
+    zoneSpeedMargin_cm = zoom ? 0 : 50;
+    copyTargetsToRecords(aos);
+    classifyZones();
+    classifyZonesRecords(aos);
+    TEST_ASSERT_EQUAL(0, countRecordMismatches(aos));
+  }
+}
+
+// Masaüstü çevrim sayısı cihazdakiyle aynı değildir; çıktı oranı göstermek içindir
+void test_benchmark_reports_both_layouts() {
+  fillTargets(3);
+  curvePath(2000);
+  processConsoleCommand("BENCH");
+  TEST_ASSERT_TRUE(Serial.wire.find("[BENCH] AoS taban") != std::string::npos);
+  TEST_ASSERT_TRUE(Serial.wire.find("(fark 0 hedef)") != std::string::npos);
+  size_t start = Serial.wire.find("[BENCH] 128");
+  TEST_MESSAGE(Serial.wire.substr(start).c_str());
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_corridor_matches_records);
+  RUN_TEST(test_zones_match_records);
+  RUN_TEST(test_benchmark_reports_both_layouts);
+  return UNITY_END();
+}
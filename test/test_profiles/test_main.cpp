@@ -0,0 +1,101 @@
+// Ekran profili senaryosu: profil derleme bayrağından gelir (SCREEN_PROFILE). platformio.ini her profil
+// için bir masaüstü ortamı tanımlar; beklenen değerler profil sabitlerinden türetilir, koordinatlar
+// ekrana yazılan komutlardan okunur.
+#include <unity.h>
+#include "Arduino.h"
+#include "host_radar.h"
+#include "radar.h"
+
+static void startScenario() {
+  memset(EEPROM.data, 0xFF, sizeof(EEPROM.data));
+  hostCanFrames.clear();
+  hostMillis = 1000;
+  setup();
+  processConsoleCommand("MARKERS 4");
+  SerialNextion.clearWire();
+}
+
+// Önde 4 m, solda 6 m ve koridor dışında sağda 4 m: en yakın öndeki, sağdaki ekran kenarına kırpılır
+void test_layout() {
+  startScenario();
+  queueRadarTarget(0, 400, 0);
+  queueRadarTarget(1, 600, -100);
+  queueRadarTarget(2, 200, 400);
+  loop();
+  std::vector<std::string> cmds = nextionCommands(SerialNextion.wire);
+
+  TEST_ASSERT_EQUAL(0, findNearestTarget());
+  int zone = targets.zone[0];
+  int grid = ZONE_GRID_CM[zone];
+  TEST_ASSERT_EQUAL(ZONE_PIC_ID[zone], lastValue(cmds, "page0.pic="));
+
+  // Eşit ölçek: yanal 0 ekran ortası, ileri mesafe genişlikle aynı ölçekte alttan yukarı
+  TEST_ASSERT_INT_WITHIN(1, SCREEN_WIDTH_PX / 2, lastValue(cmds, "rTarget.x="));
+  TEST_ASSERT_INT_WITHIN(1, SCREEN_HEIGHT_PX - 400 * SCREEN_WIDTH_PX / grid, lastValue(cmds, "rTarget.y="));
+
+  // Araç alt kenarda ortalı, genişliği aynı ölçekte
+  int vx = lastValue(cmds, "rVehicle.x="), vw = lastValue(cmds, "rVehicle.w=");
+  TEST_ASSERT_INT_WITHIN(1, SCREEN_WIDTH_PX, 2 * vx + vw);
+  TEST_ASSERT_INT_WITHIN(1, vehicleWidth_cm * SCREEN_WIDTH_PX / grid, vw);
+  TEST_ASSERT_EQUAL(SCREEN_HEIGHT_PX - VEHICLE_HEIGHT_PX, lastValue(cmds, "rVehicle.y="));
+
+  // Görünen her marker ekranın içinde; sağdaki hedefin marker'ı sağ kenara kırpılmış
+  for (int k = 0; k < markerPoolSize; k++) {
+    if (!markers[k].shown) continue;
+    TEST_ASSERT_TRUE(markers[k].x >= 0 && markers[k].x <= SCREEN_WIDTH_PX - TARGET_OBJECT_SIZE_PX);
+    TEST_ASSERT_TRUE(markers[k].y >= 0 && markers[k].y <= SCREEN_HEIGHT_PX - TARGET_OBJECT_SIZE_PX);
+    if (markers[k].slot == 2) TEST_ASSERT_EQUAL(SCREEN_WIDTH_PX - TARGET_OBJECT_SIZE_PX, markers[k].x);
+  }
+
+  // Yaklaşan hedef: daha yüksek bölge, resim değişir, marker aşağı iner
+  int y0 = lastValue(cmds, "rTarget.y=");
+  hostMillis += 100;
+  queueRadarTarget(0, 100, 0);
+  loop();
+  cmds = nextionCommands(SerialNextion.wire);
+  TEST_ASSERT_GREATER_THAN(zone, targets.zone[0]);
+  TEST_ASSERT_EQUAL(ZONE_PIC_ID[targets.zone[0]], lastValue(cmds, "page0.pic="));
+  TEST_ASSERT_GREATER_THAN(y0, lastValue(cmds, "rTarget.y="));
+}
+
+// Havuzdan büyük hedef kümesi: birincil önce, kalanlar bölge (yüksek önce) ve mesafeye göre
+void test_marker_assignment() {
+  startScenario();
+  const uint8_t ZONE[6] = { ZONE_SAFE, ZONE_DANGER, ZONE_WARNING, ZONE_DANGER, ZONE_SAFE, ZONE_WARNING };
+  const int16_t R[6]    = { 300, 450, 200, 250, 100, 500 };
+  for (int i = 0; i < 6; i++) {
+    targets.flags[i] = TGT_ACTIVE | TGT_TRACKED;
+    targets.zone[i]  = ZONE[i];
+    targets.r_cm[i]  = R[i];
+  }
+  int sel[MARKER_POOL_SIZE];
+  int n = assignMarkers(4, sel);
+  TEST_ASSERT_EQUAL(markerPoolSize, n);
+  TEST_ASSERT_EQUAL(4, sel[0]);
+  TEST_ASSERT_EQUAL(3, sel[1]);
+  TEST_ASSERT_EQUAL(1, sel[2]);
+  TEST_ASSERT_EQUAL(2, sel[3]);
+  for (int s = 0; s < n; s++) {
+    int k = markerOf(sel[s]);
+    TEST_ASSERT_TRUE(k >= 0);
+    for (int t = 0; t < s; t++) TEST_ASSERT_TRUE(markerOf(sel[t]) != k);
+  }
+}
+
+// Tamsayı piksel hattı float hesapla 65.536 data[2]/data[3] çiftinin hepsinde, her zoom kademesinde aynı
+void test_fixed_point_matches_float() {
+  startScenario();
+  for (int zoom = 0; zoom < 4; zoom++) TEST_ASSERT_EQUAL(0, fixedPointPixelMismatches(zoom));
+  TEST_ASSERT_EQUAL(0, fixedPointThresholdMismatches());
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_layout);
+  RUN_TEST(test_marker_assignment);
+  RUN_TEST(test_fixed_point_matches_float);
+  return UNITY_END();
+}
@@ -0,0 +1,58 @@
+// Kayıt oynatma: ham CAN nesne çerçeveleri (data[0..3]) tarama aralığıyla loop() üzerinden oynatılır;
+// tahminli marker konumunun bir sonraki ölçüme hatası tahminsiz (son ölçümde bekleyen) marker'dan küçük olmalı.
+#include <unity.h>
+#include "Arduino.h"
+#include "host_radar.h"
+#include "radar.h"
+
+// Önden sola doğru yaklaşan tek hedef, 100 ms tarama, 25 cm kafes: mesafe, açı (128 + derece),
+// ileri (x / 25 cm), yanal (128 + y / 25 cm). 8 m'den ~1 m'ye, ~1.8 m/s ileri ve ~0.45 m/s yanal.
+static const int SCAN_MS = 100;
+static const uint8_t APPROACH[][4] = {
+  {  33, 117,  32, 122 }, {  32, 117,  31, 122 }, {  31, 118,  31, 122 }, {  30, 118,  30, 123 }, {  30, 118,  29, 123 },
+  {  29, 118,  28, 123 }, {  28, 118,  28, 123 }, {  27, 118,  27, 123 }, {  27, 118,  26, 123 }, {  26, 118,  26, 124 },
+  {  25, 118,  25, 124 }, {  24, 119,  24, 124 }, {  24, 119,  23, 124 }, {  23, 119,  23, 124 }, {  22, 119,  22, 125 },
+  {  21, 119,  21, 125 }, {  21, 119,  20, 125 }, {  20, 120,  20, 125 }, {  19, 120,  19, 125 }, {  19, 120,  18, 125 },
+  {  18, 120,  18, 126 }, {  17, 121,  17, 126 }, {  16, 121,  16, 126 }, {  16, 121,  15, 126 }, {  15, 121,  15, 126 },
+  {  14, 122,  14, 126 }, {  13, 122,  13, 127 }, {  13, 123,  13, 127 }, {  12, 123,  12, 127 }, {  11, 124,  11, 127 },
+  {  10, 125,  10, 127 }, {  10, 126,  10, 128 }, {   9, 126,   9, 128 }, {   8, 128,   8, 128 }, {   8, 129,   8, 128 },
+  {   7, 131,   7, 128 }, {   6, 133,   6, 128 }, {   5, 135,   5, 129 }, {   5, 138,   5, 129 }, {   4, 143,   4, 129 },
+};
+static const int APPROACH_SCANS = sizeof(APPROACH) / sizeof(APPROACH[0]);
+
+static void replay(const uint8_t (*scans)[4], int count) {
+  for (int n = 0; n < count; n++) {
+    twai_message_t msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.identifier       = 0x310;
+    msg.data_length_code = 8;
+    memcpy(msg.data, scans[n], 4);
+    hostCanFrames.push_back(msg);
+    hostMillis += SCAN_MS;
+    loop();
+  }
+}
+
+void setUp() {
+  memset(EEPROM.data, 0xFF, sizeof(EEPROM.data));
+  hostCanFrames.clear();
+  hostMillis = 1000;
+  setup();
+  memset(&predStats, 0, sizeof(predStats));
+}
+void tearDown() {}
+
+void test_prediction_beats_held_position() {
+  TEST_ASSERT_TRUE(prediction_enabled);
+  replay(APPROACH, APPROACH_SCANS);
+  TEST_ASSERT_TRUE(predStats.samples >= APPROACH_SCANS - 5);
+  printf("REPLAY %u ornek: tahminli ort %u cm, tahminsiz ort %u cm\n", predStats.samples,
+         predStats.errPredictedSum_cm / predStats.samples, predStats.errHeldSum_cm / predStats.samples);
+  TEST_ASSERT_TRUE(predStats.errPredictedSum_cm < predStats.errHeldSum_cm);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_prediction_beats_held_position);
+  return UNITY_END();
+}
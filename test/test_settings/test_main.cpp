@@ -0,0 +1,99 @@
+// Ayarlar: EEPROM düzeni eski sürümden yükseltme ve kayıt/yükleme turu.
+#include <unity.h>
+#include "Arduino.h"
+#include "host_radar.h"
+#include "radar.h"
+
+void setUp() {
+  memset(EEPROM.data, 0xFF, sizeof(EEPROM.data));
+  hostCanFrames.clear();
+  hostMillis = 1000;
+  setup();  // Sihirli anahtar yok: varsayılanlar yazılır
+}
+void tearDown() {}
+
+// Yenileme sınıflarından önceki sürüm 72-79'u sıfır bırakır: sınıflar ve bütçe varsayılana döner,
+// kova saniyede varsayılan bütçe kadar dolar ve 1 s'den fazla biriktirmez.
+void test_zeroed_refresh_block_upgrades_to_defaults() {
+  refreshClass[0] = REFRESH_FRAME;
+  elementBudget_Bps = ELEMENT_BUDGET_MIN_BPS;
+  saveSettingsToEEPROM();
+  memset(EEPROM.data + ADDR_REFRESH_CLASSES, 0, ADDR_ELEMENT_BUDGET + sizeof(uint16_t) - ADDR_REFRESH_CLASSES);
+  loadSettingsFromEEPROM();
+
+  for (int el = 0; el < ELEMENT_COUNT; el++) TEST_ASSERT_EQUAL(DEFAULT_REFRESH_CLASS[el], refreshClass[el]);
+  TEST_ASSERT_EQUAL(DEFAULT_ELEMENT_BUDGET_BPS, elementBudget_Bps);
+
+  elementValue[EL_VEHICLE] = 0;  // Ekrandaki değer biliniyor: bütçe bekler
+  elementTokens_mB = 0;
+  elementRefill_ms = hostMillis;
+  hostMillis += 100;
+  const int tenth = DEFAULT_ELEMENT_BUDGET_BPS / 10;
+  TEST_ASSERT_TRUE(spendElement(EL_VEHICLE, 1, tenth));
+  TEST_ASSERT_FALSE(spendElement(EL_VEHICLE, 2, 1));
+
+  hostMillis += 5000;
+  TEST_ASSERT_TRUE(spendElement(EL_VEHICLE, 3, DEFAULT_ELEMENT_BUDGET_BPS));
+  TEST_ASSERT_FALSE(spendElement(EL_VEHICLE, 4, 1));
+}
+
+// Kayıtlı sınıf ve bütçe aynen geri okunur
+void test_refresh_settings_round_trip() {
+  refreshClass[EL_STATUS] = REFRESH_1HZ;
+  elementBudget_Bps = ELEMENT_BUDGET_MIN_BPS;
+  saveSettingsToEEPROM();
+  memcpy(refreshClass, DEFAULT_REFRESH_CLASS, sizeof(refreshClass));
+  elementBudget_Bps = DEFAULT_ELEMENT_BUDGET_BPS;
+  loadSettingsFromEEPROM();
+
+  TEST_ASSERT_EQUAL(REFRESH_1HZ, refreshClass[EL_STATUS]);
+  TEST_ASSERT_EQUAL(ELEMENT_BUDGET_MIN_BPS, elementBudget_Bps);
+}
+
+// Karmaşa maskesi 1024 baytlık EEPROM'da 264-775 arasındadır: ilk ve son hücrenin biti ilk ve son bayta düşer,
+// 776 ve sonrası bozulmaz; yüklemede maske ve açık bayrağı geri gelir.
+void test_clutter_mask_round_trip_at_both_ends() {
+  memset(clutterMask, 0, sizeof(clutterMask));
+  clutterMask[0] = 0x01;
+  clutterMask[sizeof(clutterMask) - 1] = 0x80;
+  clutterOptions = CLUTTER_OPT_ENABLE;
+  EEPROM.data[ADDR_CLUTTER_MASK + sizeof(clutterMask)] = 0xA5;
+  saveSettingsToEEPROM();
+  TEST_ASSERT_EQUAL(0x01, EEPROM.data[ADDR_CLUTTER_MASK]);
+  TEST_ASSERT_EQUAL(0x80, EEPROM.data[ADDR_CLUTTER_MASK + GRID_CELLS / 8 - 1]);
+  TEST_ASSERT_EQUAL(0xA5, EEPROM.data[ADDR_CLUTTER_MASK + GRID_CELLS / 8]);
+  TEST_ASSERT_TRUE(ADDR_CLUTTER_MASK + GRID_CELLS / 8 <= EEPROM_SIZE);
+
+  memset(clutterMask, 0, sizeof(clutterMask));
+  clutterOptions = 0;
+  loadSettingsFromEEPROM();
+  TEST_ASSERT_TRUE(clutterOptions & CLUTTER_OPT_ENABLE);
+  TEST_ASSERT_EQUAL(2, countClutterCells());
+  TEST_ASSERT_TRUE(clutterMaskedAt(0));
+  TEST_ASSERT_TRUE(clutterMaskedAt(GRID_CELLS - 1));
+}
+
+// 512 baytlık eski düzen: karmaşa bayrağı (67) ve 512 sonrası sıfır okunur. Maske kapalı ve boş gelir,
+// diğer ayarlar korunur.
+void test_legacy_512_byte_layout_leaves_clutter_off() {
+  warningZone_m = 4.0f;
+  saveSettingsToEEPROM();
+  EEPROM.data[ADDR_CLUTTER_OPTIONS] = 0;
+  memset(EEPROM.data + ADDR_CLUTTER_MASK, 0, EEPROM_SIZE - ADDR_CLUTTER_MASK);
+  clutterOptions = CLUTTER_OPT_ENABLE;
+  memset(clutterMask, 0xFF, sizeof(clutterMask));
+  loadSettingsFromEEPROM();
+
+  TEST_ASSERT_FALSE(clutterOptions & CLUTTER_OPT_ENABLE);
+  TEST_ASSERT_EQUAL(0, countClutterCells());
+  TEST_ASSERT_EQUAL(400, warningZone_cm);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_zeroed_refresh_block_upgrades_to_defaults);
+  RUN_TEST(test_refresh_settings_round_trip);
+  RUN_TEST(test_clutter_mask_round_trip_at_both_ends);
+  RUN_TEST(test_legacy_512_byte_layout_leaves_clutter_off);
+  return UNITY_END();
+}
@@ -0,0 +1,111 @@
+// SPI TFT piksel hedefi: -DDISPLAY_TFT=1 ile (pio test -e native_tft) sürücü test/host SPI kaydına yazar;
+// başlatma komutları, pencere/RAMWR başına giden bayt, DMA'da en fazla iki şerit ve aktarım sürerken
+// tamponun değişmemesi denetlenir. TFT'siz derlemede RENDER TFT reddedilir.
+#include <unity.h>
+#include "Arduino.h"
+#include "host_radar.h"
+#include "radar.h"
+
+void setUp() {
+  memset(EEPROM.data, 0xFF, sizeof(EEPROM.data));
+  hostCanFrames.clear();
+  hostMillis = 1000;
+#if DISPLAY_TFT == 1
+  hostSpiReset();
+#endif
+  setup();
+}
+void tearDown() {}
+
+#if DISPLAY_TFT == 1
+static const HostSpiCommand* findCommand(uint8_t cmd) {
+  for (size_t n = 0; n < hostSpi.commands.size(); n++) {
+    if (hostSpi.commands[n].cmd == cmd) return &hostSpi.commands[n];
+  }
+  return NULL;
+}
+
+static int wordAt(const std::vector<uint8_t>& p, int n) { return (p[n] << 8) | p[n + 1]; }
+
+// Her RAMWR: önceki CASET/RASET penceresinin alanı kadar piksel (2 bayt) gider. Pencereler ekran içinde.
+static uint32_t checkWindows(int& windows) {
+  uint32_t pixelBytes = 0;
+  int cols[2] = { -1, -1 }, rows[2] = { -1, -1 };
+  windows = 0;
+  for (size_t n = 0; n < hostSpi.commands.size(); n++) {
+    const HostSpiCommand& c = hostSpi.commands[n];
+    if (c.cmd == 0x2A) { cols[0] = wordAt(c.params, 0); cols[1] = wordAt(c.params, 2); }
+    if (c.cmd == 0x2B) { rows[0] = wordAt(c.params, 0); rows[1] = wordAt(c.params, 2); }
+    if (c.cmd != 0x2C) continue;
+    TEST_ASSERT_TRUE(cols[0] >= 0 && cols[0] <= cols[1] && cols[1] < SCREEN_WIDTH_PX);
+    TEST_ASSERT_TRUE(rows[0] >= 0 && rows[0] <= rows[1] && rows[1] < SCREEN_HEIGHT_PX);
+    TEST_ASSERT_EQUAL((cols[1] - cols[0] + 1) * (rows[1] - rows[0] + 1) * 2, c.pixelBytes);
+    pixelBytes += c.pixelBytes;
+    windows++;
+  }
+  return pixelBytes;
+}
+
+// Açılışta sink kaydolur: uyku çıkışı, 16 bit renk, yön (ILI9341: MX | BGR), ekran açık
+void test_tft_begin_registers_sink() {
+  TEST_ASSERT_NOT_NULL(pixelSink);
+  TEST_ASSERT_NOT_NULL(findCommand(0x11));
+  const HostSpiCommand* colmod = findCommand(0x3A);
+  const HostSpiCommand* madctl = findCommand(0x36);
+  TEST_ASSERT_NOT_NULL(colmod);
+  TEST_ASSERT_NOT_NULL(madctl);
+  TEST_ASSERT_EQUAL(0x55, colmod->params[0]);
+  TEST_ASSERT_EQUAL(0x48, madctl->params[0]);
+  TEST_ASSERT_NOT_NULL(findCommand(0x29));
+}
+
+// İlk kare tüm ekranı tek pencerede gönderir: 16 satırlık şeritler DMA'da en fazla ikişer, üçüncü şerit
+// beklemeye düşer; hiçbir tampon aktarım sürerken yazılmaz. Bir adım yaklaşan hedef sadece küçük pencereler
+// (eski ve yeni marker kutusu) gönderir.
+void test_tft_frame_windows_and_dma() {
+  processConsoleCommand("RENDER TFT");
+  TEST_ASSERT_TRUE(displayOptions & DISPLAY_OPT_TFT);
+  hostSpiReset();
+  uint32_t dmaWaits0 = rasterStats.dmaWaits;
+  queueRadarTarget(0, 400, 0);
+  loop();
+
+  int windows;
+  TEST_ASSERT_EQUAL(SCREEN_WIDTH_PX * SCREEN_HEIGHT_PX * 2, checkWindows(windows));
+  TEST_ASSERT_EQUAL(1, windows);
+  TEST_ASSERT_EQUAL(2, hostSpi.maxInFlight);
+  TEST_ASSERT_TRUE(rasterStats.dmaWaits > dmaWaits0);
+  TEST_ASSERT_EQUAL(0, hostSpi.overruns);
+  TEST_ASSERT_EQUAL(0, hostSpi.corrupted);
+
+  hostSpiReset();
+  hostMillis += 300;
+  queueRadarTarget(0, 375, 0);
+  loop();
+  uint32_t bytes = checkWindows(windows);
+  TEST_ASSERT_TRUE(windows >= 1);
+  TEST_ASSERT_TRUE(bytes > 0);
+  TEST_ASSERT_LESS_OR_EQUAL(2 * TARGET_OBJECT_SIZE_PX * TARGET_OBJECT_SIZE_PX * 2, bytes);  // Eski ve yeni marker kutusu
+  TEST_ASSERT_EQUAL(0, hostSpi.overruns);
+  TEST_ASSERT_EQUAL(0, hostSpi.corrupted);
+}
+#else
+// Piksel hedefi yok: RENDER TFT reddedilir, sahne seçimi değişmez
+void test_render_tft_refused_without_sink() {
+  TEST_ASSERT_NULL(pixelSink);
+  processConsoleCommand("RENDER TFT");
+  TEST_ASSERT_FALSE(displayOptions & DISPLAY_OPT_TFT);
+  TEST_ASSERT_EQUAL(RENDERER_COMPONENTS, sceneRenderer());
+}
+#endif
+
+int main(int, char**) {
+  UNITY_BEGIN();
+#if DISPLAY_TFT == 1
+  RUN_TEST(test_tft_begin_registers_sink);
+  RUN_TEST(test_tft_frame_windows_and_dma);
+#else
+  RUN_TEST(test_render_tft_refused_without_sink);
+#endif
+  return UNITY_END();
+}
@@ -0,0 +1,361 @@
+// Koridor ve bölgeler: direksiyon/yaw ile kavisli koridor, ego hareket telafisi, poligon bölgeleri,
+// karmaşa maskesi ve doluluk ızgarası. Hedefler CAN giriş yolundan (ingestCanFrame) verilir.
+#include <unity.h>
+#include "Arduino.h"
+#include "host_radar.h"
+#include "radar.h"
+
+// 25 cm kafeste hedef: ileri x, yanal y (sol +)
+static void putTarget(int slot, int x_cm, int y_cm) {
+  twai_message_t msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.identifier       = RADAR_ID_FIRST + slot;
+  msg.data_length_code = 8;
+  msg.data[0] = (uint8_t)lround(sqrt((double)x_cm * x_cm + (double)y_cm * y_cm) / 25);
+  msg.data[1] = 128;
+  msg.data[2] = (uint8_t)(x_cm / 25);
+  msg.data[3] = (uint8_t)(128 + y_cm / 25);
+  ingestCanFrame(msg, millis());
+}
+
+static void putWordFrame(uint16_t id, int offset, int16_t value, unsigned long now) {
+  twai_message_t msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.identifier       = id;
+  msg.data_length_code = 8;
+  msg.data[offset]     = (uint8_t)(value & 0xFF);
+  msg.data[offset + 1] = (uint8_t)((uint16_t)value >> 8);
+  ingestCanFrame(msg, now);
+}
+
+static bool inCorridor(int slot) {
+  return targets.flags[slot] & TGT_IN_CORRIDOR;
+}
+
+void setUp() {
+  memset(EEPROM.data, 0xFF, sizeof(EEPROM.data));
+  hostCanFrames.clear();
+  hostMillis = 1000;
+  setup();
+  memset(&targets, 0, sizeof(targets));
+  canFramesOther = 0;
+}
+void tearDown() {}
+
+// Direksiyon 15 derece, aks 300 cm: R = 300 / tan(15) = 1120 cm, halka 970-1270 cm. Yay üzerindeki hedef
+// koridorda, tam öndeki dışarıda; araç hizasında (x = 0) kavisli koridor düz koridorla aynı: |y| < 150.
+// Ters açı merkezi aynalar; ölü bölge ve bayat direksiyon düz koridora döner.
+void test_steering_corridor_follows_arc() {
+  const uint16_t STEER_ID = 0x200;
+  processConsoleCommand("STEER ID 200");
+  processConsoleCommand("STEER WB 300");
+  TEST_ASSERT_EQUAL(150, halfCorridor_cm);
+  putWordFrame(STEER_ID, STEER_ANGLE_BYTE, 150, millis());
+  TEST_ASSERT_EQUAL(0, canFramesOther);
+  TEST_ASSERT_TRUE(pathModel.curved);
+  TEST_ASSERT_EQUAL(1120, pathModel.centerY_cm);
+
+  putTarget(0, 800, 325);   // Yay üzerinde
+  putTarget(1, 800, 0);     // Tam önde, yayın dışında
+  putTarget(2, 0, 125);     // Araç hizası, sınırın içi
+  putTarget(3, 0, 150);     // Sınır
+  putTarget(4, 0, -125);
+  putTarget(5, 0, -150);
+  runTargetKernels();
+  TEST_ASSERT_TRUE(inCorridor(0));
+  TEST_ASSERT_FALSE(inCorridor(1));
+  TEST_ASSERT_TRUE(inCorridor(2));
+  TEST_ASSERT_FALSE(inCorridor(3));
+  TEST_ASSERT_TRUE(inCorridor(4));
+  TEST_ASSERT_FALSE(inCorridor(5));
+
+  putWordFrame(STEER_ID, STEER_ANGLE_BYTE, -150, millis());
+  TEST_ASSERT_EQUAL(-1120, pathModel.centerY_cm);
+  putTarget(0, 800, -325);
+  putTarget(1, 800, 325);
+  runTargetKernels();
+  TEST_ASSERT_TRUE(inCorridor(0));
+  TEST_ASSERT_FALSE(inCorridor(1));
+
+  putWordFrame(STEER_ID, STEER_ANGLE_BYTE, STEER_DEADBAND_DDEG - 1, millis());
+  TEST_ASSERT_FALSE(pathModel.curved);
+
+  putWordFrame(STEER_ID, STEER_ANGLE_BYTE, 150, millis());
+  hostMillis += STEER_TIMEOUT_MS + 1;
+  putTarget(1, 800, 0);
+  runTargetKernels();
+  TEST_ASSERT_TRUE(pathModel.curved);
+  TEST_ASSERT_TRUE(inCorridor(1));  // Bayat direksiyon: düz koridor
+}
+
+// Hız çerçevesi: data[0..1] 0.01 km/h, data[2..3] yaw 0.01 derece/s
+static void putSpeed(int16_t speed_kmh100, int16_t yaw_dps100) {
+  twai_message_t msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.identifier       = 0x201;
+  msg.data_length_code = 8;
+  msg.data[SPEED_BYTE]     = (uint8_t)(speed_kmh100 & 0xFF);
+  msg.data[SPEED_BYTE + 1] = (uint8_t)((uint16_t)speed_kmh100 >> 8);
+  msg.data[YAW_BYTE]       = (uint8_t)(yaw_dps100 & 0xFF);
+  msg.data[YAW_BYTE + 1]   = (uint8_t)((uint16_t)yaw_dps100 >> 8);
+  ingestCanFrame(msg, millis());
+}
+
+// 3.6 km/h (100 cm/s) ileri giderken 100 cm/s yaklaşan nesne zemine göre sabit, 200 cm/s yaklaşan hareketli.
+// Bölge payı hız x 1 s, 500 cm'de kırpılır; uyarı kapısı pay kadar genişler. Araç dururken sabit nesne
+// buzzer'ı çalmaz; hız verisi bayatlayınca bastırma ve pay kalkar.
+void test_ego_motion_static_targets_and_margin() {
+  processConsoleCommand("SPEED ID 201");
+  const int slow = 0, fast = 1;
+  for (int n = 0; n < 12; n++) {
+    putSpeed(360, 0);
+    putTarget(slow, 1000 - 25 * n, 0);
+    putTarget(fast, 1400 - 50 * n, 0);
+    runTargetKernels();
+    hostMillis += 250;
+  }
+  TEST_ASSERT_TRUE(egoValid);
+  TEST_ASSERT_EQUAL(100, egoSpeed_cms);
+  TEST_ASSERT_EQUAL(100, zoneSpeedMargin_cm);
+  TEST_ASSERT_INT_WITHIN(STATIC_TARGET_CMS - 1, 0, targets.groundVx_cms[slow]);
+  TEST_ASSERT_TRUE(targets.flags[slow] & TGT_STATIC);
+  TEST_ASSERT_INT_WITHIN(STATIC_TARGET_CMS - 1, -100, targets.groundVx_cms[fast]);
+  TEST_ASSERT_FALSE(targets.flags[fast] & TGT_STATIC);
+
+  memset(&targets, 0, sizeof(targets));
+  putTarget(slow, warningZone_cm + 75, 0);  // Kapının dışında, pay 100 cm ile içinde
+  runTargetKernels();
+  updateBuzzerFromTargets();
+  TEST_ASSERT_EQUAL(slow, alarmTarget);
+
+  putSpeed(3600, 0);  // 10 km/h: pay 1000 cm değil 500 cm
+  runTargetKernels();
+  TEST_ASSERT_EQUAL(ZONE_SPEED_MARGIN_MAX_CM, zoneSpeedMargin_cm);
+
+  hostMillis += SPEED_TIMEOUT_MS + 1;
+  putTarget(slow, warningZone_cm + 75, 0);
+  runTargetKernels();
+  updateBuzzerFromTargets();
+  TEST_ASSERT_FALSE(egoValid);
+  TEST_ASSERT_EQUAL(0, zoneSpeedMargin_cm);
+  TEST_ASSERT_EQUAL(-1, alarmTarget);
+
+  // Durmuş araç, yerinde duran nesne: bastırılır; hız bayatlayınca alarm verir
+  memset(&targets, 0, sizeof(targets));
+  for (int n = 0; n < 3; n++) {
+    putSpeed(0, 0);
+    putTarget(slow, 300, 0);
+    runTargetKernels();
+    hostMillis += 100;
+  }
+  updateBuzzerFromTargets();
+  TEST_ASSERT_TRUE(targets.flags[slow] & TGT_STATIC);
+  TEST_ASSERT_EQUAL(-1, alarmTarget);
+
+  hostMillis += SPEED_TIMEOUT_MS + 1;
+  putTarget(slow, 300, 0);
+  runTargetKernels();
+  updateBuzzerFromTargets();
+  TEST_ASSERT_EQUAL(slow, alarmTarget);
+}
+
+// Direksiyon yokken yaw: 7.2 km/h (200 cm/s), 11.46 derece/s (199 mrad/s) -> R = 200000 / 199 = 1005 cm.
+// Yanal zemin hızı göreli + w*x: 800 cm öndeki, yerinde duran izli nesne için 159 cm/s. Minimum hızın
+// altında ve YAW OFF ile düz koridora döner.
+void test_yaw_rate_curves_corridor_and_ground_velocity() {
+  processConsoleCommand("SPEED ID 201");
+  processConsoleCommand("SPEED YAW ON");
+  putSpeed(720, 1146);
+  TEST_ASSERT_EQUAL(199, egoYaw_mrads);
+  TEST_ASSERT_TRUE(pathModel.curved);
+  TEST_ASSERT_EQUAL(1005, pathModel.centerY_cm);
+
+  putTarget(0, 800, 0);
+  runTargetKernels();
+  putTarget(0, 800, 0);
+  runTargetKernels();
+  TEST_ASSERT_EQUAL(0, targets.vy_cms[0]);
+  TEST_ASSERT_EQUAL(199 * 800 / 1000, targets.groundVy_cms[0]);
+  TEST_ASSERT_FALSE(inCorridor(0));  // R = 1005 yayının dışında
+
+  putSpeed((YAW_MIN_SPEED_CMS - 1) * 18 / 5, 1146);
+  TEST_ASSERT_FALSE(pathModel.curved);
+
+  putSpeed(720, 1146);
+  processConsoleCommand("SPEED YAW OFF");
+  TEST_ASSERT_EQUAL(0, egoYaw_mrads);
+  TEST_ASSERT_FALSE(pathModel.curved);
+}
+
+// Izgara hücresinin poligon seviyesi; x, y kafes noktası (25 cm'nin katı)
+static int levelAt(int x_cm, int y_cm) {
+  return zoneLevelAt((y_cm / GRID_CELL_CM + GRID_Y_CELLS / 2) * GRID_X_CELLS + x_cm / GRID_CELL_CM);
+}
+
+// Konsoldan üç bölge: kırmızı dikdörtgen, onu kapsayan (sonra eklenen) sarı dikdörtgen, turuncu üçgen.
+// Satırlar yarı açık: alt kenar satırı içeride, üst kenar satırı dışarıda; sütunlarda kenar üzerindeki hücre
+// içeride. Çakışmada ekleme sırası fark etmez, yüksek seviye kalır. Poligon modunda mesafe kapısı yok;
+// bölgeler yeniden açılışta EEPROM'dan geri gelir.
+void test_polygon_zone_scanline_boundaries() {
+  processConsoleCommand("ZONE NEW 3");
+  processConsoleCommand("ZONE ADD 0 100,-50");
+  processConsoleCommand("ZONE ADD 0 300,-50");
+  processConsoleCommand("ZONE ADD 0 300,50");
+  TEST_ASSERT_TRUE(polyZonesActive);  // Üç köşe yeterli
+  processConsoleCommand("ZONE ADD 0 100,50");
+  processConsoleCommand("ZONE NEW 1");
+  processConsoleCommand("ZONE ADD 1 -100,-200");
+  processConsoleCommand("ZONE ADD 1 600,-200");
+  processConsoleCommand("ZONE ADD 1 600,200");
+  processConsoleCommand("ZONE ADD 1 -100,200");
+  processConsoleCommand("ZONE NEW 2");
+  processConsoleCommand("ZONE ADD 2 700,0");
+  processConsoleCommand("ZONE ADD 2 1100,0");
+  processConsoleCommand("ZONE ADD 2 700,400");
+
+  TEST_ASSERT_EQUAL(ZONE_ALARM,   levelAt(100, -50));
+  TEST_ASSERT_EQUAL(ZONE_ALARM,   levelAt(300, 25));
+  TEST_ASSERT_EQUAL(ZONE_WARNING, levelAt(325, 0));
+  TEST_ASSERT_EQUAL(ZONE_WARNING, levelAt(75, 0));
+  TEST_ASSERT_EQUAL(ZONE_WARNING, levelAt(100, 50));   // Üst kenar satırı kırmızıya girmez
+  TEST_ASSERT_EQUAL(ZONE_WARNING, levelAt(100, -75));
+
+  TEST_ASSERT_EQUAL(ZONE_WARNING, levelAt(0, 0));      // Negatif x sıfırdan kırpılır
+  TEST_ASSERT_EQUAL(ZONE_WARNING, levelAt(600, -200));
+  TEST_ASSERT_EQUAL(ZONE_SAFE,    levelAt(625, 0));
+  TEST_ASSERT_EQUAL(ZONE_SAFE,    levelAt(0, 200));
+  TEST_ASSERT_EQUAL(ZONE_SAFE,    levelAt(0, -225));
+
+  // Eğik kenar x = 1100 - y
+  TEST_ASSERT_EQUAL(ZONE_DANGER, levelAt(700, 100));
+  TEST_ASSERT_EQUAL(ZONE_DANGER, levelAt(1000, 100));
+  TEST_ASSERT_EQUAL(ZONE_SAFE,   levelAt(1025, 100));
+  TEST_ASSERT_EQUAL(ZONE_SAFE,   levelAt(675, 100));
+  TEST_ASSERT_EQUAL(ZONE_DANGER, levelAt(1100, 0));
+  TEST_ASSERT_EQUAL(ZONE_DANGER, levelAt(725, 375));
+  TEST_ASSERT_EQUAL(ZONE_SAFE,   levelAt(750, 375));
+  TEST_ASSERT_EQUAL(ZONE_SAFE,   levelAt(700, 400));
+
+  putTarget(0, 1000, 100);
+  putTarget(1, 1125, 0);
+  runTargetKernels();
+  updateBuzzerFromTargets();
+  TEST_ASSERT_EQUAL(ZONE_DANGER, targets.zone[0]);
+  TEST_ASSERT_TRUE(inCorridor(0));
+  TEST_ASSERT_EQUAL(ZONE_SAFE, targets.zone[1]);
+  TEST_ASSERT_FALSE(inCorridor(1));
+  TEST_ASSERT_EQUAL(0, alarmTarget);
+
+  setup();
+  TEST_ASSERT_TRUE(polyZonesActive);
+  TEST_ASSERT_EQUAL(ZONE_ALARM,  levelAt(100, -50));
+  TEST_ASSERT_EQUAL(ZONE_DANGER, levelAt(700, 100));
+
+  processConsoleCommand("ZONE DEL 2");
+  TEST_ASSERT_EQUAL(ZONE_SAFE, levelAt(700, 100));
+  TEST_ASSERT_EQUAL(ZONE_ALARM, levelAt(100, -50));
+  processConsoleCommand("ZONE CLEAR");
+  TEST_ASSERT_FALSE(polyZonesActive);
+  TEST_ASSERT_EQUAL(ZONE_SAFE, levelAt(100, -50));
+}
+
+static int cellAt(int x_cm, int y_cm) {
+  return (y_cm / GRID_CELL_CM + GRID_Y_CELLS / 2) * GRID_X_CELLS + x_cm / GRID_CELL_CM;
+}
+
+// 5 s öğrenme = 25 örnek. Her örnekte görülen hedef ve 13/25 (%52) görülen hedef maskelenir, 12/25 (%48)
+// görülen maskelenmez. Maske bir hücre genişler: çapraz komşu içeride, iki hücre öteki dışarıda; ızgara
+// köşesinde genişleme kenarda kırpılır (4 hücre). Maskeli hücreye düşen çerçeve depoya yazılmadan sayılıp atılır.
+void test_clutter_learn_mask_and_dilation() {
+  processConsoleCommand("CLUTTER LEARN 5");
+  TEST_ASSERT_TRUE(clutterLearning);
+  TEST_ASSERT_EQUAL(25, clutterSamplesTarget);
+  for (int n = 0; n < 25; n++) {
+    memset(&targets, 0, sizeof(targets));
+    putTarget(0, 500, 0);
+    if (n < 12) putTarget(1, 800, 100);
+    if (n < 13) putTarget(2, 1000, -100);
+    putTarget(3, 0, -GRID_Y_CELLS / 2 * GRID_CELL_CM);
+    learnClutter(hostMillis);
+    hostMillis += CLUTTER_SAMPLE_MS;
+  }
+  TEST_ASSERT_FALSE(clutterLearning);
+  TEST_ASSERT_TRUE(clutterOptions & CLUTTER_OPT_ENABLE);
+  TEST_ASSERT_EQUAL(9 + 9 + 4, countClutterCells());
+
+  TEST_ASSERT_TRUE(clutterMaskedAt(cellAt(525, 25)));
+  TEST_ASSERT_TRUE(clutterMaskedAt(cellAt(475, -25)));
+  TEST_ASSERT_FALSE(clutterMaskedAt(cellAt(550, 0)));
+  TEST_ASSERT_FALSE(clutterMaskedAt(cellAt(500, 50)));
+  TEST_ASSERT_FALSE(clutterMaskedAt(cellAt(800, 100)));
+  TEST_ASSERT_TRUE(clutterMaskedAt(cellAt(1025, -125)));
+  TEST_ASSERT_TRUE(clutterMaskedAt(cellAt(25, -775)));
+  TEST_ASSERT_FALSE(clutterMaskedAt(cellAt(50, -775)));
+
+  memset(&targets, 0, sizeof(targets));
+  clutterRejected = 0;
+  putTarget(0, 525, 25);
+  putTarget(1, 550, 0);
+  TEST_ASSERT_EQUAL(0, targets.flags[0]);
+  TEST_ASSERT_TRUE(targets.flags[1] & TGT_ACTIVE);
+  TEST_ASSERT_EQUAL(1, clutterRejected);
+
+  processConsoleCommand("CLUTTER OFF");
+  putTarget(0, 525, 25);
+  TEST_ASSERT_TRUE(targets.flags[0] & TGT_ACTIVE);
+  TEST_ASSERT_EQUAL(1, clutterRejected);
+  TEST_ASSERT_EQUAL(22, countClutterCells());  // Kapatmak maskeyi silmez
+}
+
+// Doluluk: çerçeve başına bir isabet (aynı taramanın ikinci çekirdek turu eklemez), 255'te doyma.
+// Sönüm çağrı sıklığından bağımsız 250 ms'de bir 7/8: 1 s'de 10 ms adımla tam 4 sönüm. 255'ten 14 sönüm
+// sonra katman eşiğinin üstünde, 15'te altında. Onay açıkken tek isabetli hedef alarm vermez, ikincide verir.
+void test_occupancy_hits_decay_and_confirm() {
+  memset(occupancy, 0, sizeof(occupancy));
+  const int cell = cellAt(300, 0);
+  processConsoleCommand("OCC CONFIRM ON");
+  putTarget(0, 300, 0);
+  runTargetKernels();
+  runTargetKernels();
+  updateBuzzerFromTargets();
+  TEST_ASSERT_EQUAL(OCC_HIT, occupancy[cell]);
+  TEST_ASSERT_EQUAL(-1, alarmTarget);
+
+  putTarget(0, 300, 0);
+  runTargetKernels();
+  updateBuzzerFromTargets();
+  TEST_ASSERT_EQUAL(2 * OCC_HIT, occupancy[cell]);
+  TEST_ASSERT_EQUAL(0, alarmTarget);
+  for (int n = 0; n < 3; n++) {
+    putTarget(0, 300, 0);
+    runTargetKernels();
+  }
+  TEST_ASSERT_EQUAL(255, occupancy[cell]);
+
+  occNextDecay_ms = hostMillis;
+  unsigned long t0 = hostMillis;
+  for (; hostMillis < t0 + 1000; hostMillis += 10) decayOccupancy(hostMillis);
+  TEST_ASSERT_EQUAL(148, occupancy[cell]);  // 255 -> 223 -> 195 -> 170 -> 148
+
+  occupancy[cell] = 255;
+  for (int n = 0; n < 14; n++) {
+    hostMillis += OCC_DECAY_MS;
+    decayOccupancy(hostMillis);
+  }
+  TEST_ASSERT_TRUE(occupancy[cell] >= OCC_OVERLAY_MIN);
+  hostMillis += OCC_DECAY_MS;
+  decayOccupancy(hostMillis);
+  TEST_ASSERT_TRUE(occupancy[cell] < OCC_OVERLAY_MIN);
+  TEST_ASSERT_EQUAL(0, occupancy[cellAt(325, 0)]);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_steering_corridor_follows_arc);
+  RUN_TEST(test_ego_motion_static_targets_and_margin);
+  RUN_TEST(test_yaw_rate_curves_corridor_and_ground_velocity);
+  RUN_TEST(test_polygon_zone_scanline_boundaries);
+  RUN_TEST(test_clutter_learn_mask_and_dilation);
+  RUN_TEST(test_occupancy_hits_decay_and_confirm);
+  return UNITY_END();
+}